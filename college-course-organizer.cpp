@@ -3,122 +3,3341 @@
 #include <QtWidgets>
 #include <QtSql>
 #include <vector>
-#include <queue>
+#include <algorithm>
+#include <utility>
+#include <numeric>
+#include <memory>
+#include <limits>
+#include <map>
+#include <list>
+#include <set>
+#include <array>
+#include <functional>
+#include <atomic>
 #include <string>
 #include <string_view>
 #include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <bit>
+#include <cmath>
+
+#if defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#endif
 
 // Domain types and enum mapping
 enum class AssignType { HW, Quiz, Midterm, Final, Project, Essay, Other };
 
-static QString toString(AssignType t) {
-    switch (t) {
-    case AssignType::HW: return "HW";
-    case AssignType::Quiz: return "Quiz";
-    case AssignType::Midterm: return "Midterm";
-    case AssignType::Final: return "Final";
-    case AssignType::Project: return "Project";
-    case AssignType::Essay: return "Essay";
-    default: return "Other";
+// Labels are interned: every row shares one QString per type.
+static const QString& toString(AssignType t) {
+    static const std::array<QString, 7> labels{QStringLiteral("HW"), QStringLiteral("Quiz"), QStringLiteral("Midterm"),
+                                               QStringLiteral("Final"), QStringLiteral("Project"), QStringLiteral("Essay"),
+                                               QStringLiteral("Other")};
+    return labels[std::min(std::size_t(t), labels.size() - 1)];
+}
+
+static AssignType parseAssignType(const QString& s) {
+    if (s == "HW") return AssignType::HW;
+    if (s == "Quiz") return AssignType::Quiz;
+    if (s == "Midterm") return AssignType::Midterm;
+    if (s == "Final") return AssignType::Final;
+    if (s == "Project") return AssignType::Project;
+    if (s == "Essay") return AssignType::Essay;
+    return AssignType::Other;
+}
+
+struct Semester { int id{}; QString term; int year{}; };
+
+struct Course {
+    int id{}, userId{}, semesterId{};
+    QString code, name, colorHex;
+};
+
+struct Assignment {
+    int id{}, courseId{};
+    AssignType type{AssignType::Other};
+    QString title;
+    QDateTime dueAtUtc;
+    std::optional<QString> topics, notes;
+    std::optional<QDateTime> startAtUtc;  // opens a work window or marks an exam's start
+    int durationMin{0};                    // 0 = no explicit length
+    double effortHours{0};                 // 0 = not estimated
+};
+
+using DueKey = std::pair<qint64, int>;  // (due_at_utc seconds, assignment id)
+
+// Min-heap comparator for "Upcoming" deadlines (soonest first)
+struct DueSooner {
+    bool operator()(const Assignment& a, const Assignment& b) const {
+        return a.dueAtUtc != b.dueAtUtc ? a.dueAtUtc > b.dueAtUtc : a.id > b.id;
+    }
+};
+
+// Recurring assignments: one assignment_series row stands for a weekly
+// cadence (the FREQ=WEEKLY;INTERVAL;UNTIL/COUNT subset of RRULE) and is only
+// expanded for the window a view asks for. Occurrences carry synthetic ids
+// below -1 that encode (series, index), so the id-keyed views treat them like
+// rows; editing one materializes it as a real row and skips the index.
+static constexpr int kMaxOccurrences = 1024;  // per series; ~20 years weekly
+
+static constexpr int occurrenceId(int seriesId, int n) { return -2 - (seriesId * kMaxOccurrences + n); }
+static constexpr bool isOccurrenceId(int id) { return id < -1; }
+static constexpr int occurrenceSeries(int id) { return (-2 - id) / kMaxOccurrences; }
+static constexpr int occurrenceIndex(int id) { return (-2 - id) % kMaxOccurrences; }
+// Highest series id whose occurrence ids all fit in an int
+static constexpr int kMaxSeriesId = (std::numeric_limits<int>::max() - kMaxOccurrences) / kMaxOccurrences;
+static_assert(occurrenceId(kMaxSeriesId, kMaxOccurrences - 1) < -1, "occurrence ids must not overflow");
+
+struct AssignmentSeries {
+    int id{-1}, courseId{};
+    AssignType type{AssignType::Other};
+    QString title;
+    std::optional<QString> topics, notes;
+    qint64 firstDueUtc{};
+    int intervalWeeks{1};
+    std::optional<qint64> untilUtc;  // inclusive
+    int count{0};                     // 0 = until untilUtc (or the cap)
+    int durationMin{0};
+    double effortHours{0};
+    QTimeZone zone{QTimeZone::systemTimeZone()};  // the wall clock kept across DST changes
+    std::vector<int> skipped;         // sorted occurrence indexes
+
+    int occurrenceLimit() const { return count > 0 ? std::min(count, kMaxOccurrences) : kMaxOccurrences; }
+    qint64 dueAt(int n) const {
+        const QDateTime first = QDateTime::fromSecsSinceEpoch(firstDueUtc, zone);
+        return QDateTime(first.date().addDays(qint64(7) * intervalWeeks * n), first.time(), zone).toSecsSinceEpoch();
+    }
+    // Occurrences due at or after `from`, counted without expanding them.
+    int countFrom(qint64 from) const {
+        const int limit = occurrenceLimit();
+        const qint64 period = qint64(7 * 86400) * intervalWeeks;
+        int first = int(std::clamp<qint64>(from > firstDueUtc ? (from - firstDueUtc) / period - 1 : 0, 0, limit));  // -1: DST slack
+        while (first < limit && dueAt(first) < from) ++first;
+        int end = limit;  // one past the last occurrence
+        if (untilUtc) {
+            end = int(std::clamp<qint64>(*untilUtc >= firstDueUtc ? (*untilUtc - firstDueUtc) / period + 2 : 0, 0, limit));  // +2: DST slack
+            while (end > 0 && dueAt(end - 1) > *untilUtc) --end;
+        }
+        if (first >= end) return 0;
+        const auto gone = std::lower_bound(skipped.begin(), skipped.end(), end) - std::lower_bound(skipped.begin(), skipped.end(), first);
+        return end - first - int(gone);
+    }
+    Assignment occurrence(int n) const {
+        Assignment a;
+        a.id = occurrenceId(id, n);
+        a.courseId = courseId; a.type = type; a.title = title;
+        a.dueAtUtc = QDateTime::fromSecsSinceEpoch(dueAt(n), QTimeZone::utc());
+        a.topics = topics; a.notes = notes; a.durationMin = durationMin; a.effortHours = effortHours;
+        return a;
+    }
+};
+
+// Appends occurrences keyed after `after` in (due, id) order: at most `limit`,
+// none due past lastDue. The first candidate index is computed, so the cost
+// tracks what is returned rather than the series' length.
+static void expandSeries(const AssignmentSeries& s, DueKey after, std::size_t limit, qint64 lastDue, std::vector<Assignment>& out) {
+    const qint64 period = qint64(7 * 86400) * s.intervalWeeks;
+    const qint64 skip = after.first > s.firstDueUtc ? (after.first - s.firstDueUtc) / period - 1 : 0;  // -1: DST slack
+    for (int n = int(std::clamp<qint64>(skip, 0, s.occurrenceLimit())), added = 0; n < s.occurrenceLimit() && std::size_t(added) < limit; ++n) {
+        const qint64 due = s.dueAt(n);
+        if (due > lastDue || (s.untilUtc && due > *s.untilUtc)) break;
+        if (DueKey{due, occurrenceId(s.id, n)} <= after || std::binary_search(s.skipped.begin(), s.skipped.end(), n)) continue;
+        out.push_back(s.occurrence(n));
+        ++added;
+    }
+}
+
+// Bounded top-K selection: keeps only the K best items pushed so far.
+// Cmp has std::priority_queue semantics (cmp(a,b) == "a ranks after b"), so
+// DueSooner can be reused as-is. Memory is O(K) and each push is O(log K).
+template <class T, class Cmp>
+class BoundedTopK {
+public:
+    explicit BoundedTopK(std::size_t k, Cmp cmp = Cmp{}) : k_(k), cmp_(cmp) { heap_.reserve(k_); }
+
+    void push(T v) {
+        if (k_ == 0) return;
+        // Root of heap_ is the worst entry kept; it is replaced when v ranks ahead of it.
+        const auto before = [this](const T& a, const T& b) { return cmp_(b, a); };
+        if (heap_.size() < k_) {
+            heap_.push_back(std::move(v));
+            std::push_heap(heap_.begin(), heap_.end(), before);
+        } else if (before(v, heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), before);
+            heap_.back() = std::move(v);
+            std::push_heap(heap_.begin(), heap_.end(), before);
+        }
+    }
+    std::size_t size() const { return heap_.size(); }
+    std::size_t capacity() const { return k_; }
+
+    // Drains the selection, best first.
+    std::vector<T> takeSorted() {
+        std::sort_heap(heap_.begin(), heap_.end(), [this](const T& a, const T& b) { return cmp_(b, a); });
+        return std::exchange(heap_, {});
+    }
+
+private:
+    std::size_t k_;
+    Cmp cmp_;
+    std::vector<T> heap_;
+};
+
+static constexpr int kDefaultUpcomingLimit = 10;
+
+// UpcomingIndex: the persistent "next K deadlines" window behind the Upcoming
+// panel. Entries are ordered by (due, id) with an id -> key lookup, and each
+// delta reports the affected row so the list is patched rather than rebuilt.
+// complete() means the DB holds nothing beyond the last entry; otherwise a
+// removal leaves a gap that the caller refills with a keyset query. A ranked
+// reset (the "Most urgent" order) keys entries by position instead; such a
+// window is only ever reset or shrunk, never re-keyed or refilled.
+class UpcomingIndex {
+public:
+    using Key = DueKey;
+
+    std::function<void(int row, const Assignment&)> inserted;
+    std::function<void(int row, int id)> removed;
+
+    static Key keyOf(const Assignment& a) { return {a.dueAtUtc.toSecsSinceEpoch(), a.id}; }
+
+    void reset(std::vector<Assignment> items, int k, bool ranked = false) {
+        entries_.clear(); byId_.clear();
+        k_ = std::max(k, 0);
+        complete_ = int(items.size()) < k_;
+        for (auto& a : items) {
+            if (int(entries_.size()) >= k_) { complete_ = false; break; }
+            const Key key = ranked ? Key{qint64(entries_.size()), a.id} : keyOf(a);
+            byId_.insert(a.id, key);
+            entries_.emplace(key, std::move(a));
+        }
+    }
+
+    // Add or re-key an assignment (new, edited, or moved in time).
+    void upsert(const Assignment& a, qint64 nowUtc) {
+        take(a.id);
+        if (a.dueAtUtc.toSecsSinceEpoch() < nowUtc) return;
+        const Key key = keyOf(a);
+        if (int(entries_.size()) >= k_) {
+            if (k_ == 0 || key > lastKey()) { complete_ = false; return; }
+            take(std::prev(entries_.end())->second.id);  // evicted entry now lives beyond the window
+            complete_ = false;
+        } else if (!complete_ && (entries_.empty() || key > lastKey())) {
+            return;  // unseen rows may sit before key; the refill will bring it in order
+        }
+        insert(key, a);
+    }
+    void remove(int id) { take(id); }
+    void removeCourse(int courseId) {
+        std::vector<int> ids;
+        for (const auto& [key, a] : entries_) if (a.courseId == courseId) ids.push_back(a.id);
+        for (int id : ids) take(id);
+    }
+
+    // Appends a keyset page fetched after lastKey(); returns how many rows were added.
+    int appendRefill(std::vector<Assignment> items, int requested) {
+        int added = 0;
+        for (auto& a : items) {
+            if (byId_.contains(a.id)) continue;
+            const Key key = keyOf(a);
+            if (!entries_.empty() && key <= lastKey()) continue;
+            if (int(entries_.size()) >= k_) { complete_ = false; return added; }
+            insert(key, a); ++added;
+        }
+        if (int(items.size()) < requested) complete_ = true;
+        return added;
+    }
+
+    bool needsRefill() const { return !complete_ && int(entries_.size()) < k_; }
+    int missing() const { return k_ - int(entries_.size()); }
+    Key lastKey() const {
+        return entries_.empty() ? Key{std::numeric_limits<qint64>::min(), std::numeric_limits<int>::min()}
+                                : std::prev(entries_.end())->first;
+    }
+    const std::map<Key, Assignment>& entries() const { return entries_; }
+
+private:
+    void insert(const Key& key, const Assignment& a) {
+        auto it = entries_.emplace(key, a).first;
+        byId_.insert(a.id, key);
+        if (inserted) inserted(int(std::distance(entries_.begin(), it)), it->second);
+    }
+    void take(int id) {
+        auto it = byId_.find(id);
+        if (it == byId_.end()) return;
+        auto e = entries_.find(*it);
+        const int row = int(std::distance(entries_.begin(), e));
+        entries_.erase(e); byId_.erase(it);
+        if (removed) removed(row, id);
+    }
+
+    int k_{0};
+    bool complete_{true};
+    std::map<Key, Assignment> entries_;
+    QHash<int, Key> byId_;
+};
+
+// Reminder lead times per AssignType, in minutes before due (0 = none).
+// Read from [reminders] in coursepilot.ini, keyed by type label: HW=1440, ...
+struct ReminderLeads {
+    std::array<int, 7> minutes{1440, 1440, 2880, 4320, 2880, 1440, 720};  // HW, Quiz, Midterm, Final, Project, Essay, Other
+
+    int of(AssignType t) const { return minutes[std::size_t(t)]; }
+    void load(const QSettings& s) {
+        for (std::size_t i = 0; i < minutes.size(); ++i)
+            minutes[i] = std::max(0, s.value("reminders/" + toString(AssignType(i)), minutes[i]).toInt());
+    }
+};
+
+// ReminderScheduler: one single-shot timer armed for the earliest pending
+// reminder. Pending reminders sit in a set ordered by (fire time, id) with an
+// id lookup beside it, so upsert/remove are O(log n) and the timer is re-armed
+// only when the head changes. With nothing pending no timer runs at all. Fed
+// from the Upcoming window, so it tracks exactly the K deadlines shown there.
+class ReminderScheduler {
+public:
+    // Everything that came due at one wake-up, soonest deadline first.
+    std::function<void(const std::vector<Assignment>&)> fired;
+
+    ReminderScheduler() {
+        timer_.setSingleShot(true);
+        timer_.setTimerType(Qt::VeryCoarseTimer);  // second resolution is plenty
+        QObject::connect(&timer_, &QTimer::timeout, [this] { fireDue(); });
+    }
+
+    void setLeads(const ReminderLeads& leads) { leads_ = leads; }
+
+    template <class Entries>
+    void reset(const Entries& entries) {
+        queue_.clear(); pending_.clear();
+        for (const auto& [key, a] : entries) enqueue(a);
+        arm();
+    }
+    void upsert(const Assignment& a) { dequeue(a.id); enqueue(a); arm(); }
+    void remove(int id) { if (dequeue(id)) arm(); }
+    std::size_t pending() const { return queue_.size(); }
+
+private:
+    // invariant: queue_ and pending_ hold the same ids
+    void enqueue(const Assignment& a) {
+        const int lead = leads_.of(a.type);
+        const qint64 due = a.dueAtUtc.toSecsSinceEpoch();
+        if (lead <= 0 || notified_.value(a.id, std::numeric_limits<qint64>::min()) == due) return;
+        const qint64 fireAt = due - qint64(lead) * 60;
+        queue_.emplace(fireAt, a.id);
+        pending_.insert(a.id, {fireAt, a});
+    }
+    bool dequeue(int id) {
+        auto it = pending_.find(id);
+        if (it == pending_.end()) return false;
+        queue_.erase({it->fireAt, id});
+        pending_.erase(it);
+        return true;
+    }
+    void arm() {
+        if (queue_.empty()) { timer_.stop(); armedFor_ = kNone; return; }
+        const qint64 head = queue_.begin()->first;
+        if (head == armedFor_ && timer_.isActive()) return;
+        armedFor_ = head;
+        // Capped so long waits survive clock changes and suspend; each wake-up just re-arms.
+        const qint64 waitSec = std::clamp<qint64>(head - QDateTime::currentSecsSinceEpoch(), 0, kMaxWaitSec);
+        timer_.start(std::chrono::seconds(waitSec));
+    }
+    void fireDue() {
+        armedFor_ = kNone;
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        std::vector<Assignment> due;
+        while (!queue_.empty() && queue_.begin()->first <= now) {
+            const int id = queue_.begin()->second;
+            due.push_back(pending_.value(id).assignment);
+            notified_.insert(id, due.back().dueAtUtc.toSecsSinceEpoch());
+            dequeue(id);
+        }
+        std::sort(due.begin(), due.end(), [](const Assignment& a, const Assignment& b) { return DueSooner{}(b, a); });
+        if (!due.empty() && fired) fired(due);
+        arm();
+    }
+
+    struct Pending { qint64 fireAt{}; Assignment assignment; };
+    static constexpr qint64 kNone = std::numeric_limits<qint64>::min();
+    static constexpr qint64 kMaxWaitSec = 6 * 3600;
+
+    ReminderLeads leads_;
+    std::set<std::pair<qint64, int>> queue_;  // (fire at, id)
+    QHash<int, Pending> pending_;
+    QHash<int, qint64> notified_;             // id -> due time already reminded about
+    QTimer timer_;
+    qint64 armedFor_{kNone};
+};
+
+// RefreshScheduler: views are marked dirty and reloaded together once per
+// event-loop turn, so a slot that touches several views, or several slots in
+// a row, costs one reload per view. settle() waits until marks stop arriving
+// for kSettleMs first (keyboard navigation through a list); a mark() of the
+// same view in the meantime supersedes it.
+class RefreshScheduler {
+public:
+    enum View : unsigned { Courses = 1, Assignments = 2, Upcoming = 4, Conflicts = 8, Search = 16 };
+    static constexpr int kSettleMs = 90;
+
+    // Receives the dirty views; views marked while it runs go to the next turn.
+    std::function<void(unsigned)> flush;
+
+    RefreshScheduler() {
+        turn_.setSingleShot(true);
+        turn_.setInterval(0);
+        QObject::connect(&turn_, &QTimer::timeout, [this] { run(); });
+        settle_.setSingleShot(true);
+        settle_.setInterval(kSettleMs);
+        QObject::connect(&settle_, &QTimer::timeout, [this] { mark(std::exchange(settling_, 0u)); });
+    }
+
+    void mark(unsigned views) {
+        if (!views) return;
+        dirty_ |= views;
+        if (!turn_.isActive()) turn_.start();
+    }
+    void settle(unsigned views) {
+        settling_ |= views;
+        settle_.start();  // restarts
+    }
+
+private:
+    void run() {
+        const unsigned views = std::exchange(dirty_, 0u);
+        settling_ &= ~views;
+        if (!settling_) settle_.stop();
+        if (views && flush) flush(views);
+    }
+
+    QTimer turn_, settle_;
+    unsigned dirty_{0}, settling_{0};
+};
+
+// Per-semester course metadata keyed by course id. Filled once by loadCourses
+// and patched after CourseDialog saves, so views never look courses up per row.
+class CourseDirectory {
+public:
+    void reset(int semesterId) { semesterId_ = semesterId; byId_.clear(); }
+    void upsert(const Course& c) { byId_.insert(c.id, c); }
+    void remove(int courseId) { byId_.remove(courseId); }
+    const Course* find(int courseId) const {
+        auto it = byId_.constFind(courseId);
+        return it == byId_.cend() ? nullptr : &*it;
+    }
+    QString code(int courseId) const { const auto* c = find(courseId); return c ? c->code : QString(); }
+    int semesterId() const { return semesterId_; }
+
+    // Course list order, matching the old "ORDER BY code" listing.
+    static bool byCode(const Course& a, const Course& b) { return a.code != b.code ? a.code < b.code : a.id < b.id; }
+
+private:
+    int semesterId_{-1};
+    QHash<int, Course> byId_;
+};
+
+// Fixed-capacity map that evicts the least recently used entry; find()
+// counts as a use. Values stay put until evicted or removed.
+template <class K, class V>
+class LruCache {
+public:
+    explicit LruCache(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+    const V* find(const K& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return nullptr;
+        order_.splice(order_.begin(), order_, it->second);
+        return &it->second->second;
+    }
+    void put(const K& key, V value) {
+        if (auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            order_.splice(order_.begin(), order_, it->second);
+            return;
+        }
+        order_.emplace_front(key, std::move(value));
+        index_.emplace(key, order_.begin());
+        while (order_.size() > capacity_) { index_.erase(order_.back().first); order_.pop_back(); }
+    }
+    void remove(const K& key) {
+        if (auto it = index_.find(key); it != index_.end()) { order_.erase(it->second); index_.erase(it); }
+    }
+    // Removes the entry and hands its value back.
+    std::optional<V> take(const K& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return std::nullopt;
+        std::optional<V> v(std::move(it->second->second));
+        order_.erase(it->second); index_.erase(it);
+        return v;
+    }
+    void clear() { order_.clear(); index_.clear(); }
+    std::size_t size() const { return order_.size(); }
+
+private:
+    using Entries = std::list<std::pair<K, V>>;  // most recent first
+    std::size_t capacity_;
+    Entries order_;
+    std::unordered_map<K, typename Entries::iterator> index_;
+};
+
+// Time an assignment blocks out, as [begin, end) in UTC seconds.
+struct ScheduleSpan { qint64 begin{}, end{}; };
+
+static bool isExam(AssignType t) { return t == AssignType::Quiz || t == AssignType::Midterm || t == AssignType::Final; }
+
+// With a start: [start, start + duration), or the window [start, due) without
+// one. With only a duration: [due, due + duration). Bare deadlines block no
+// time, except exams, which count as a one-second instant so two at the same
+// moment still collide.
+static std::optional<ScheduleSpan> scheduleSpan(AssignType type, qint64 due, std::optional<qint64> start, int durationMin) {
+    const qint64 len = qint64(std::max(durationMin, 0)) * 60;
+    qint64 begin = due, end = due;
+    if (start) { begin = *start; end = len > 0 ? begin + len : due; }
+    else if (len > 0) end = due + len;
+    else if (!isExam(type)) return std::nullopt;
+    return ScheduleSpan{begin, std::max(end, begin + 1)};
+}
+
+static std::optional<ScheduleSpan> scheduleSpan(const Assignment& a) {
+    return scheduleSpan(a.type, a.dueAtUtc.toSecsSinceEpoch(),
+                        a.startAtUtc ? std::optional<qint64>(a.startAtUtc->toSecsSinceEpoch()) : std::nullopt, a.durationMin);
+}
+
+// ConflictIndex: every overlapping pair of spans within one user's semester.
+// reset() finds them with a sweep over begin-sorted spans, O(n log n + pairs).
+// upsert()/remove() patch only the pairs touching one entry with a window query
+// on the begin-ordered set: anything overlapping [b, e) begins in
+// (b - maxLen, e), where maxLen is the longest span currently held.
+class ConflictIndex {
+public:
+    struct Entry { int id{}; ScheduleSpan span; };
+    using Pair = std::pair<int, int>;  // (smaller id, larger id)
+
+    // Stand-alone sweep, also used for one-off batch runs over many users.
+    static std::vector<Pair> sweep(std::vector<Entry> entries) {
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.span.begin != b.span.begin ? a.span.begin < b.span.begin : a.id < b.id;
+        });
+        std::vector<Pair> out;
+        std::multimap<qint64, int> active;  // end -> id, for spans that began earlier
+        for (const auto& e : entries) {
+            while (!active.empty() && active.begin()->first <= e.span.begin) active.erase(active.begin());
+            for (const auto& [end, id] : active) out.push_back(std::minmax(id, e.id));
+            active.emplace(e.span.end, e.id);
+        }
+        return out;
+    }
+
+    void reset(std::vector<Entry> entries) {
+        byBegin_.clear(); spans_.clear(); lengths_.clear(); pairs_.clear(); partners_.clear();
+        for (const auto& e : entries) insertSpan(e.id, e.span);
+        for (const auto& [a, b] : sweep(std::move(entries))) link(a, b);
+    }
+
+    // nullopt drops the entry (it no longer blocks time).
+    void upsert(int id, std::optional<ScheduleSpan> span) {
+        remove(id);
+        if (!span) return;
+        for (int other : overlapping(*span)) link(id, other);
+        insertSpan(id, *span);
+    }
+
+    void remove(int id) {
+        auto it = spans_.find(id);
+        if (it == spans_.end()) return;
+        byBegin_.erase({it->begin, id});
+        lengths_.erase(lengths_.find(it->end - it->begin));
+        spans_.erase(it);
+        for (int other : partners_.take(id)) {
+            partners_[other].remove(id);
+            pairs_.erase(std::minmax(id, other));
+        }
+    }
+
+    // Ids whose spans overlap s.
+    std::vector<int> overlapping(ScheduleSpan s) const {
+        std::vector<int> out;
+        if (lengths_.empty()) return out;
+        const qint64 maxLen = *lengths_.rbegin();
+        for (auto it = byBegin_.lower_bound({s.begin - maxLen + 1, std::numeric_limits<int>::min()});
+             it != byBegin_.end() && it->first.first < s.end; ++it)
+            if (it->second > s.begin) out.push_back(it->first.second);
+        return out;
+    }
+
+    const std::set<Pair>& pairs() const { return pairs_; }
+    bool contains(int id) const { return spans_.contains(id); }
+    std::size_t size() const { return std::size_t(spans_.size()); }
+
+private:
+    void insertSpan(int id, ScheduleSpan s) {
+        byBegin_.emplace(std::make_pair(s.begin, id), s.end);
+        spans_.insert(id, s);
+        lengths_.insert(s.end - s.begin);
+    }
+    void link(int a, int b) {
+        pairs_.insert(std::minmax(a, b));
+        partners_[a].insert(b);
+        partners_[b].insert(a);
+    }
+
+    std::map<std::pair<qint64, int>, qint64> byBegin_;  // (begin, id) -> end
+    QHash<int, ScheduleSpan> spans_;
+    std::multiset<qint64> lengths_;
+    std::set<Pair> pairs_;
+    QHash<int, QSet<int>> partners_;
+};
+
+// StringArena: UTF-16 text packed into one buffer and addressed by
+// (offset, size). intern() stores each distinct string once, so repeated
+// titles ("Homework 3") and topic tags cost one copy per arena.
+class StringArena {
+public:
+    struct Ref { std::uint32_t offset{}, size{}; };
+
+    Ref intern(QStringView s) {
+        if (s.isEmpty()) return {};
+        const std::size_t h = qHash(s);
+        for (auto [it, end] = index_.equal_range(h); it != end; ++it)
+            if (view(it->second) == s) return it->second;
+        const Ref r{std::uint32_t(chars_.size()), std::uint32_t(s.size())};
+        chars_.insert(chars_.end(), s.utf16(), s.utf16() + s.size());
+        index_.emplace(h, r);
+        return r;
+    }
+    // Views stay valid only until the next intern().
+    QStringView view(Ref r) const { return QStringView(chars_.data() + r.offset, qsizetype(r.size)); }
+    std::size_t bytes() const { return chars_.size() * sizeof(char16_t); }
+    void clear() { chars_.clear(); index_.clear(); }
+
+private:
+    std::vector<char16_t> chars_;
+    std::unordered_multimap<std::size_t, Ref> index_;
+};
+
+// AssignmentStore: struct-of-arrays assignment rows for scanning. Times stay
+// int64 seconds as SQLite stores them, the type is one byte, the course is a
+// dense index into courseIds_, and text lives in a StringArena. Scans over
+// dues/types touch contiguous memory; materialize() builds the QDateTime-based
+// Assignment only for rows that are actually shown. remove() swaps the last
+// row into the hole, so row order is insertion order until the first removal.
+class AssignmentStore {
+public:
+    using Row = std::uint32_t;
+    static constexpr qint64 kNoStart = std::numeric_limits<qint64>::min();
+
+    std::size_t size() const { return ids_.size(); }
+    bool empty() const { return ids_.empty(); }
+    void clear() {
+        ids_.clear(); due_.clear(); start_.clear(); duration_.clear(); effort_.clear(); type_.clear(); course_.clear();
+        title_.clear(); topics_.clear(); rowOf_.clear(); courseIds_.clear(); courseIndex_.clear(); text_.clear();
+    }
+    void reserve(std::size_t n) {
+        ids_.reserve(n); due_.reserve(n); start_.reserve(n); duration_.reserve(n); effort_.reserve(n); type_.reserve(n); course_.reserve(n);
+        title_.reserve(n); topics_.reserve(n);
+    }
+
+    // Inserts, or overwrites the row that already holds id.
+    Row upsert(int id, int courseId, AssignType type, qint64 due, QStringView title, QStringView topics,
+               qint64 start = kNoStart, int durationMin = 0, float effortHours = 0) {
+        auto it = rowOf_.constFind(id);
+        const Row r = it != rowOf_.cend() ? *it : Row(ids_.size());
+        if (r == ids_.size()) {
+            ids_.push_back(id); due_.emplace_back(); start_.emplace_back(); duration_.emplace_back(); effort_.emplace_back(); type_.emplace_back();
+            course_.emplace_back(); title_.emplace_back(); topics_.emplace_back();
+            rowOf_.insert(id, r);
+        }
+        due_[r] = due; start_[r] = start; duration_[r] = durationMin; effort_[r] = effortHours;
+        type_[r] = std::uint8_t(type);
+        course_[r] = denseCourse(courseId);
+        title_[r] = text_.intern(title);
+        topics_[r] = text_.intern(topics);
+        return r;
+    }
+    Row upsert(const Assignment& a) {
+        return upsert(a.id, a.courseId, a.type, a.dueAtUtc.toSecsSinceEpoch(), a.title, a.topics.value_or(QString()),
+                      a.startAtUtc ? a.startAtUtc->toSecsSinceEpoch() : kNoStart, a.durationMin, float(a.effortHours));
+    }
+    // Copies row r of o straight from its columns, without an Assignment in between.
+    Row append(const AssignmentStore& o, Row r) {
+        return upsert(o.ids_[r], o.courseId(r), o.type(r), o.due_[r], o.title(r), o.topics(r), o.start_[r], o.duration_[r], o.effort_[r]);
+    }
+    void append(const AssignmentStore& o) {
+        reserve(size() + o.size());
+        for (Row r = 0; r < o.size(); ++r) append(o, r);
+    }
+
+    void remove(int id) {
+        auto it = rowOf_.find(id);
+        if (it == rowOf_.end()) return;
+        const Row r = *it, last = Row(ids_.size() - 1);
+        rowOf_.erase(it);
+        if (r != last) {
+            ids_[r] = ids_[last]; due_[r] = due_[last]; start_[r] = start_[last]; duration_[r] = duration_[last]; effort_[r] = effort_[last];
+            type_[r] = type_[last]; course_[r] = course_[last]; title_[r] = title_[last]; topics_[r] = topics_[last];
+            rowOf_[ids_[r]] = r;
+        }
+        ids_.pop_back(); due_.pop_back(); start_.pop_back(); duration_.pop_back(); effort_.pop_back(); type_.pop_back();
+        course_.pop_back(); title_.pop_back(); topics_.pop_back();
+    }
+
+    // Order-preserving removal of rows [first, first + count).
+    void eraseRows(Row first, Row count) {
+        if (count == 0) return;
+        for (Row r = first; r < first + count; ++r) rowOf_.remove(ids_[r]);
+        const auto cut = [first, count](auto& v) { v.erase(v.begin() + first, v.begin() + first + count); };
+        cut(ids_); cut(due_); cut(start_); cut(duration_); cut(effort_); cut(type_); cut(course_); cut(title_); cut(topics_);
+        for (Row r = first; r < ids_.size(); ++r) rowOf_[ids_[r]] = r;
+    }
+
+    std::optional<Row> rowOf(int id) const {
+        auto it = rowOf_.constFind(id);
+        return it == rowOf_.cend() ? std::nullopt : std::optional<Row>(*it);
+    }
+
+    int id(Row r) const { return ids_[r]; }
+    qint64 due(Row r) const { return due_[r]; }
+    std::optional<qint64> start(Row r) const { return start_[r] == kNoStart ? std::nullopt : std::optional<qint64>(start_[r]); }
+    int durationMin(Row r) const { return duration_[r]; }
+    float effortHours(Row r) const { return effort_[r]; }
+    AssignType type(Row r) const { return AssignType(type_[r]); }
+    int courseId(Row r) const { return courseIds_[course_[r]]; }
+    // Dense course index of r, below courseSlots(); for per-course tallies.
+    std::uint32_t courseSlot(Row r) const { return course_[r]; }
+    std::size_t courseSlots() const { return courseIds_.size(); }
+    QStringView title(Row r) const { return text_.view(title_[r]); }
+    QStringView topics(Row r) const { return text_.view(topics_[r]); }
+    const std::vector<qint64>& dues() const { return due_; }
+    std::size_t textBytes() const { return text_.bytes(); }
+
+    std::optional<ScheduleSpan> span(Row r) const { return scheduleSpan(type(r), due_[r], start(r), duration_[r]); }
+
+    Assignment materialize(Row r) const {
+        Assignment a;
+        a.id = ids_[r]; a.courseId = courseId(r); a.type = type(r);
+        a.title = title(r).toString();
+        a.dueAtUtc = QDateTime::fromSecsSinceEpoch(due_[r]).toUTC();
+        if (topics_[r].size != 0) a.topics = topics(r).toString();
+        if (start_[r] != kNoStart) a.startAtUtc = QDateTime::fromSecsSinceEpoch(start_[r]).toUTC();
+        a.durationMin = duration_[r];
+        a.effortHours = effort_[r];
+        return a;
+    }
+
+private:
+    std::uint32_t denseCourse(int courseId) {
+        auto it = courseIndex_.constFind(courseId);
+        if (it != courseIndex_.cend()) return *it;
+        courseIds_.push_back(courseId);
+        return *courseIndex_.insert(courseId, std::uint32_t(courseIds_.size() - 1));
+    }
+
+    std::vector<int> ids_;
+    std::vector<qint64> due_, start_;
+    std::vector<std::int32_t> duration_;
+    std::vector<float> effort_;
+    std::vector<std::uint8_t> type_;
+    std::vector<std::uint32_t> course_;
+    std::vector<StringArena::Ref> title_, topics_;
+    QHash<int, Row> rowOf_;
+    std::vector<int> courseIds_;
+    QHash<int, std::uint32_t> courseIndex_;
+    StringArena text_;
+};
+
+// priority_queue-style "a ranks after b" over store rows, like DueSooner.
+struct StoreDueSooner {
+    const AssignmentStore* store;
+    bool operator()(AssignmentStore::Row a, AssignmentStore::Row b) const {
+        const qint64 da = store->due(a), db = store->due(b);
+        return da != db ? da > db : store->id(a) > store->id(b);
+    }
+};
+
+// Priority scoring for the "Most urgent" Upcoming order. A model scores every
+// row of a store in one pass so per-course tallies are computed once per
+// batch; higher scores rank first. moreOpen holds, per course id, the open
+// items that are not rows of the store (series occurrences left unexpanded).
+class PriorityModel {
+public:
+    virtual ~PriorityModel() = default;
+    virtual void score(const AssignmentStore& rows, qint64 nowUtc, const QHash<int, int>& moreOpen, std::vector<double>& out) const = 0;
+};
+
+// Workload model: expected hours of work per hour left before the deadline,
+// scaled by how much an item of that type weighs and by how many other open
+// items the same course has queued. Items without an effort estimate use the
+// type's typical effort.
+class WorkloadPriority final : public PriorityModel {
+public:
+    // Indexed like AssignType: HW, Quiz, Midterm, Final, Project, Essay, Other
+    static constexpr std::array<double, 7> kWeight{1.0, 1.2, 2.5, 3.5, 2.5, 1.8, 1.0};
+    static constexpr std::array<double, 7> kTypicalEffortHours{3, 1.5, 8, 12, 15, 6, 2};
+    static constexpr double kLoadStep = 0.1;  // per other open item in the course
+    static constexpr double kMaxLoad = 2.0;
+
+    void score(const AssignmentStore& rows, qint64 nowUtc, const QHash<int, int>& moreOpen, std::vector<double>& out) const override {
+        std::vector<std::uint32_t> open(rows.courseSlots(), 0);
+        for (AssignmentStore::Row r = 0; r < rows.size(); ++r) {
+            auto& n = open[rows.courseSlot(r)];
+            if (n == 0) n = std::uint32_t(moreOpen.value(rows.courseId(r)));
+            ++n;
+        }
+        out.resize(rows.size());
+        for (AssignmentStore::Row r = 0; r < rows.size(); ++r) {
+            const auto t = std::size_t(rows.type(r));
+            const double effort = rows.effortHours(r) > 0 ? rows.effortHours(r) : kTypicalEffortHours[t];
+            const double hoursLeft = std::max(double(rows.due(r) - nowUtc) / 3600.0, 1.0);
+            const double load = std::min(kMaxLoad, 1.0 + kLoadStep * (open[rows.courseSlot(r)] - 1.0));
+            out[r] = kWeight[t] * effort / hoursLeft * load;
+        }
+    }
+};
+
+// "a ranks after b" by descending score, ties broken by (due, id).
+struct StoreMoreUrgent {
+    const AssignmentStore* store;
+    const std::vector<double>* scores;
+    bool operator()(AssignmentStore::Row a, AssignmentStore::Row b) const {
+        const double sa = (*scores)[a], sb = (*scores)[b];
+        return sa != sb ? sa < sb : StoreDueSooner{store}(a, b);
+    }
+};
+
+// Startup tracer: timestamped phases since the first mark in main(). With
+// COURSEPILOT_TRACE_STARTUP=1 each phase is echoed to stderr as it happens;
+// Debug > Startup Timings shows the same list. GUI thread only.
+class StartupTrace {
+public:
+    static StartupTrace& instance() { static StartupTrace t; return t; }
+
+    void mark(const char* phase) {
+        const qint64 ns = timer_.nsecsElapsed();
+        phases_.push_back({phase, ns});
+        if (echo_) qInfo("[startup] %8.2f ms  %s", ns / 1e6, phase);
+    }
+    // For phases reached from callbacks that also fire later on.
+    void markOnce(const char* phase) {
+        for (const auto& p : phases_) if (qstrcmp(p.first, phase) == 0) return;
+        mark(phase);
+    }
+    QString report() const {
+        QString out;
+        qint64 prev = 0;
+        for (const auto& [phase, ns] : phases_) {
+            out += QString("%1 ms  (+%2)  %3\n").arg(ns / 1e6, 8, 'f', 2).arg((ns - prev) / 1e6, 7, 'f', 2).arg(QLatin1String(phase));
+            prev = ns;
+        }
+        return out;
+    }
+
+private:
+    StartupTrace() : echo_(qEnvironmentVariableIntValue("COURSEPILOT_TRACE_STARTUP") != 0) { timer_.start(); }
+
+    QElapsedTimer timer_;
+    bool echo_;
+    std::vector<std::pair<const char*, qint64>> phases_;
+};
+
+// SQLite DB setup and migrations
+// Resolved once: QStandardPaths lookups and mkpath are not free on every connection open.
+static QString appDataPath() {
+    static const QString p = [] {
+        auto path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(path);
+        return path;
+    }();
+    return p;
+}
+
+static QString settingsPath() { return appDataPath() + "/coursepilot.ini"; }
+
+// coursepilot.db in the app data directory, unless redirected (the benchmark
+// works on a scratch file and never touches the real database).
+static QString& databasePathOverride() { static QString p; return p; }
+static QString databasePath() {
+    const QString& o = databasePathOverride();
+    return o.isEmpty() ? appDataPath() + "/coursepilot.db" : o;
+}
+// Finished semesters, next to the live file: coursepilot.db -> coursepilot-archive.db.
+static QString archivePath() {
+    const QFileInfo live(databasePath());
+    return live.dir().filePath(live.completeBaseName() + "-archive." + live.suffix());
+}
+
+// SQLite storage profile, applied to every connection right after it opens.
+// Defaults favour WAL with synchronous=NORMAL so a one-row commit costs no
+// journal fsync; [storage] in coursepilot.ini and command-line options override.
+struct StorageProfile {
+    QString journalMode = QStringLiteral("WAL");
+    QString synchronous = QStringLiteral("NORMAL");
+    QString tempStore = QStringLiteral("MEMORY");
+    qint64 mmapSizeBytes = 64ll * 1024 * 1024;
+    int cacheSizeKiB = 8 * 1024;
+    int busyTimeoutMs = 5000;
+    int checkpointIntervalSec = 300;  // PRAGMA wal_checkpoint(PASSIVE); 0 disables
+    int optimizeIntervalSec = 3600;   // PRAGMA optimize; 0 disables
+
+    static StorageProfile& active() { static StorageProfile p; return p; }
+
+    void load(const QSettings& s) {
+        journalMode = s.value("storage/journal_mode", journalMode).toString().toUpper();
+        synchronous = s.value("storage/synchronous", synchronous).toString().toUpper();
+        tempStore = s.value("storage/temp_store", tempStore).toString().toUpper();
+        mmapSizeBytes = s.value("storage/mmap_size", mmapSizeBytes).toLongLong();
+        cacheSizeKiB = s.value("storage/cache_size_kib", cacheSizeKiB).toInt();
+        busyTimeoutMs = s.value("storage/busy_timeout_ms", busyTimeoutMs).toInt();
+        checkpointIntervalSec = s.value("storage/checkpoint_interval_s", checkpointIntervalSec).toInt();
+        optimizeIntervalSec = s.value("storage/optimize_interval_s", optimizeIntervalSec).toInt();
+    }
+
+    static void addOptions(QCommandLineParser& p) {
+        p.addOption(QCommandLineOption(QStringLiteral("journal-mode"), QStringLiteral("SQLite journal mode (WAL, DELETE, TRUNCATE, ...)."), QStringLiteral("mode")));
+        p.addOption(QCommandLineOption(QStringLiteral("synchronous"), QStringLiteral("SQLite synchronous level (OFF, NORMAL, FULL, EXTRA)."), QStringLiteral("level")));
+        p.addOption(QCommandLineOption(QStringLiteral("mmap-size"), QStringLiteral("Memory-mapped I/O size in bytes."), QStringLiteral("bytes")));
+        p.addOption(QCommandLineOption(QStringLiteral("cache-size"), QStringLiteral("Page cache size in KiB."), QStringLiteral("kib")));
+        p.addOption(QCommandLineOption(QStringLiteral("temp-store"), QStringLiteral("Temp storage (DEFAULT, FILE, MEMORY)."), QStringLiteral("where")));
+        p.addOption(QCommandLineOption(QStringLiteral("busy-timeout"), QStringLiteral("Lock wait in milliseconds."), QStringLiteral("ms")));
+    }
+    void applyOptions(const QCommandLineParser& p) {
+        if (p.isSet("journal-mode")) journalMode = p.value("journal-mode").toUpper();
+        if (p.isSet("synchronous")) synchronous = p.value("synchronous").toUpper();
+        if (p.isSet("mmap-size")) mmapSizeBytes = p.value("mmap-size").toLongLong();
+        if (p.isSet("cache-size")) cacheSizeKiB = p.value("cache-size").toInt();
+        if (p.isSet("temp-store")) tempStore = p.value("temp-store").toUpper();
+        if (p.isSet("busy-timeout")) busyTimeoutMs = p.value("busy-timeout").toInt();
+    }
+
+    // PRAGMAs cannot take bound values, so names are whitelisted and numbers formatted.
+    QStringList pragmas() const {
+        static const QStringList journals{"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"};
+        static const QStringList syncs{"OFF", "NORMAL", "FULL", "EXTRA"};
+        static const QStringList temps{"DEFAULT", "FILE", "MEMORY"};
+        QStringList out;
+        out << QString("PRAGMA busy_timeout=%1").arg(std::max(busyTimeoutMs, 0));
+        if (journals.contains(journalMode)) out << "PRAGMA journal_mode=" + journalMode;
+        else qWarning() << "Ignoring unknown journal_mode" << journalMode;
+        if (syncs.contains(synchronous)) out << "PRAGMA synchronous=" + synchronous;
+        else qWarning() << "Ignoring unknown synchronous level" << synchronous;
+        if (temps.contains(tempStore)) out << "PRAGMA temp_store=" + tempStore;
+        else qWarning() << "Ignoring unknown temp_store" << tempStore;
+        out << QString("PRAGMA mmap_size=%1").arg(std::max<qint64>(mmapSizeBytes, 0));
+        out << QString("PRAGMA cache_size=-%1").arg(std::max(cacheSizeKiB, 0));
+        return out;
+    }
+    bool usesWal() const { return journalMode == "WAL"; }
+};
+
+static void applyStorageProfile(QSqlDatabase& db, const StorageProfile& p) {
+    QSqlQuery q(db);
+    for (const auto& sql : p.pragmas())
+        if (!q.exec(sql)) qWarning() << "PRAGMA failed:" << sql << q.lastError().text();
+}
+
+// Read-only connections (the archive) keep the file's own journal mode and
+// only get a busy timeout; they cannot switch it to WAL anyway.
+static bool ensureDbOpen(QSqlDatabase& db, const QString& connection = QLatin1String(QSqlDatabase::defaultConnection),
+                         const QString& path = databasePath(), bool readOnly = false) {
+    if (db.isOpen()) return true;
+    db = QSqlDatabase::addDatabase("QSQLITE", connection);
+    db.setDatabaseName(path);
+    if (readOnly) db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+    if (!db.open()) return false;
+    if (readOnly) { QSqlQuery(db).exec(QString("PRAGMA busy_timeout=%1").arg(std::max(StorageProfile::active().busyTimeoutMs, 0))); return true; }
+    applyStorageProfile(db, StorageProfile::active());
+    // Per connection and off by default in SQLite; deletes rely on ON DELETE CASCADE.
+    QSqlQuery(db).exec("PRAGMA foreign_keys=ON");
+    return true;
+}
+
+// Versioned schema: each step runs once, in its own transaction, and bumps
+// PRAGMA user_version. Databases created before versioning report 0 and pick
+// up step 1 as a no-op (IF NOT EXISTS) before receiving the later steps.
+struct MigrationStep {
+    int version;
+    const char* name;
+    std::vector<const char*> sql;
+    bool rebuildsTables = false;  // runs with foreign_keys off, checked before commit
+};
+
+// FTS sync triggers, shared by the step that adds them and the table rebuild that drops them.
+static constexpr const char* kFtsInsertTrigger = R"SQL(
+    CREATE TRIGGER IF NOT EXISTS assignments_fts_ai AFTER INSERT ON assignments BEGIN
+      INSERT INTO assignments_fts(rowid, title, topics, notes) VALUES (new.id, new.title, new.topics, new.notes);
+    END;
+    )SQL";
+static constexpr const char* kFtsDeleteTrigger = R"SQL(
+    CREATE TRIGGER IF NOT EXISTS assignments_fts_ad AFTER DELETE ON assignments BEGIN
+      INSERT INTO assignments_fts(assignments_fts, rowid, title, topics, notes) VALUES ('delete', old.id, old.title, old.topics, old.notes);
+    END;
+    )SQL";
+static constexpr const char* kFtsUpdateTrigger = R"SQL(
+    CREATE TRIGGER IF NOT EXISTS assignments_fts_au AFTER UPDATE OF title, topics, notes ON assignments BEGIN
+      INSERT INTO assignments_fts(assignments_fts, rowid, title, topics, notes) VALUES ('delete', old.id, old.title, old.topics, old.notes);
+      INSERT INTO assignments_fts(rowid, title, topics, notes) VALUES (new.id, new.title, new.topics, new.notes);
+    END;
+    )SQL";
+
+// Change capture for sync (see pushSync): local inserts, updates and deletes
+// append to change_log and stamp sync_clock, keyed by the row's uid. Inserts
+// get their uid here. Nothing is recorded while a sync batch or an archive
+// move runs (sync_state 'applying', only ever set inside that transaction).
+#define CP_SYNC_LOCAL "NOT EXISTS (SELECT 1 FROM sync_state WHERE key = 'applying' AND value = 1)"
+#define CP_SYNC_STAMP(T, UID) \
+    " INSERT INTO change_log(tbl, uid, op) SELECT '" T "', " UID ", 'upsert' FROM " T " WHERE id = new.id;" \
+    " INSERT OR REPLACE INTO sync_clock(tbl, uid, changed_at, device) SELECT '" T "', " UID ", " \
+    "CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER), (SELECT value FROM sync_state WHERE key = 'device') FROM " T " WHERE id = new.id;"
+#define CP_SYNC_TRIGGERS(T) \
+    "CREATE TRIGGER IF NOT EXISTS " T "_sync_ai AFTER INSERT ON " T " WHEN " CP_SYNC_LOCAL " BEGIN" \
+    " UPDATE " T " SET uid = lower(hex(randomblob(16))) WHERE id = new.id AND uid IS NULL;" CP_SYNC_STAMP(T, "uid") " END", \
+    /* old.uid is NULL only for the uid fill above */ \
+    "CREATE TRIGGER IF NOT EXISTS " T "_sync_au AFTER UPDATE ON " T " WHEN old.uid IS NOT NULL AND " CP_SYNC_LOCAL " BEGIN" \
+    CP_SYNC_STAMP(T, "uid") " END", \
+    "CREATE TRIGGER IF NOT EXISTS " T "_sync_ad AFTER DELETE ON " T " WHEN old.uid IS NOT NULL AND " CP_SYNC_LOCAL " BEGIN" \
+    " INSERT INTO change_log(tbl, uid, op) VALUES ('" T "', old.uid, 'delete');" \
+    " INSERT OR REPLACE INTO sync_clock(tbl, uid, changed_at, device) VALUES ('" T "', old.uid, " \
+    "CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER), (SELECT value FROM sync_state WHERE key = 'device')); END"
+
+static const std::vector<MigrationStep>& migrationSteps() {
+    static const std::vector<MigrationStep> steps = {
+        {1, "base schema", {
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS users(
+              id INTEGER PRIMARY KEY AUTOINCREMENT,
+              username TEXT UNIQUE NOT NULL,
+              password_hash BLOB NOT NULL,
+              created_at INTEGER NOT NULL
+            );
+            )SQL",
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS semesters(
+              id INTEGER PRIMARY KEY AUTOINCREMENT,
+              term TEXT NOT NULL CHECK(term IN ('Fall','Spring')),
+              year INTEGER NOT NULL
+            );
+            )SQL",
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS courses(
+              id INTEGER PRIMARY KEY AUTOINCREMENT,
+              user_id INTEGER NOT NULL,
+              semester_id INTEGER NOT NULL,
+              code TEXT NOT NULL,
+              name TEXT NOT NULL,
+              color_hex TEXT NOT NULL,
+              FOREIGN KEY(user_id) REFERENCES users(id),
+              FOREIGN KEY(semester_id) REFERENCES semesters(id)
+            );
+            )SQL",
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS assignments(
+              id INTEGER PRIMARY KEY AUTOINCREMENT,
+              course_id INTEGER NOT NULL,
+              type TEXT NOT NULL,
+              title TEXT NOT NULL,
+              due_at_utc INTEGER NOT NULL,
+              topics TEXT NULL,
+              notes TEXT NULL,
+              FOREIGN KEY(course_id) REFERENCES courses(id)
+            );
+            )SQL",
+        }},
+        {2, "hot-path indexes", {
+            // loadAssignments and the Upcoming join: equality on course, range/order on due
+            "CREATE INDEX IF NOT EXISTS idx_assignments_course_due ON assignments(course_id, due_at_utc)",
+            // loadCourses reads id/code/name/color straight from the index
+            "CREATE INDEX IF NOT EXISTS idx_courses_user_sem_code ON courses(user_id, semester_id, code, name, color_hex)",
+            // SemesterPicker::onOk lookup
+            "CREATE INDEX IF NOT EXISTS idx_semesters_term_year ON semesters(term, year)",
+        }},
+        {3, "password kdf parameters", {
+            // Existing rows keep their unsalted SHA-256 until the next successful login rehashes them
+            "ALTER TABLE users ADD COLUMN password_algo TEXT NOT NULL DEFAULT 'sha256'",
+            "ALTER TABLE users ADD COLUMN password_salt BLOB NULL",
+            "ALTER TABLE users ADD COLUMN password_iter INTEGER NOT NULL DEFAULT 0",
+        }},
+        {4, "assignment full-text search", {
+            // External-content FTS5 index over assignments; the triggers keep it in step
+            R"SQL(
+            CREATE VIRTUAL TABLE IF NOT EXISTS assignments_fts USING fts5(
+              title, topics, notes,
+              content='assignments', content_rowid='id',
+              tokenize='unicode61 remove_diacritics 2'
+            );
+            )SQL",
+            kFtsInsertTrigger, kFtsDeleteTrigger, kFtsUpdateTrigger,
+            // Index the rows that predate the table
+            "INSERT INTO assignments_fts(assignments_fts) VALUES ('rebuild')",
+        }},
+        {5, "assignment time spans", {
+            "ALTER TABLE assignments ADD COLUMN start_at_utc INTEGER NULL",
+            "ALTER TABLE assignments ADD COLUMN duration_min INTEGER NULL",
+        }},
+        {6, "cascading foreign keys", {
+            // SQLite cannot alter a constraint, so both tables are rebuilt (the
+            // documented 12-step procedure). Rows orphaned by the old two-statement
+            // course delete are left behind instead of failing the check.
+            R"SQL(
+            CREATE TABLE courses_new(
+              id INTEGER PRIMARY KEY AUTOINCREMENT,
+              user_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+              semester_id INTEGER NOT NULL REFERENCES semesters(id) ON DELETE CASCADE,
+              code TEXT NOT NULL,
+              name TEXT NOT NULL,
+              color_hex TEXT NOT NULL
+            );
+            )SQL",
+            R"SQL(
+            INSERT INTO courses_new(id, user_id, semester_id, code, name, color_hex)
+            SELECT id, user_id, semester_id, code, name, color_hex FROM courses
+            WHERE user_id IN (SELECT id FROM users) AND semester_id IN (SELECT id FROM semesters);
+            )SQL",
+            R"SQL(
+            CREATE TABLE assignments_new(
+              id INTEGER PRIMARY KEY AUTOINCREMENT,
+              course_id INTEGER NOT NULL REFERENCES courses(id) ON DELETE CASCADE,
+              type TEXT NOT NULL,
+              title TEXT NOT NULL,
+              due_at_utc INTEGER NOT NULL,
+              topics TEXT NULL,
+              notes TEXT NULL,
+              start_at_utc INTEGER NULL,
+              duration_min INTEGER NULL
+            );
+            )SQL",
+            R"SQL(
+            INSERT INTO assignments_new(id, course_id, type, title, due_at_utc, topics, notes, start_at_utc, duration_min)
+            SELECT id, course_id, type, title, due_at_utc, topics, notes, start_at_utc, duration_min FROM assignments
+            WHERE course_id IN (SELECT id FROM courses_new);
+            )SQL",
+            "DROP TABLE assignments",
+            "DROP TABLE courses",
+            "ALTER TABLE courses_new RENAME TO courses",
+            "ALTER TABLE assignments_new RENAME TO assignments",
+            // Dropped along with the old tables
+            "CREATE INDEX IF NOT EXISTS idx_assignments_course_due ON assignments(course_id, due_at_utc)",
+            "CREATE INDEX IF NOT EXISTS idx_courses_user_sem_code ON courses(user_id, semester_id, code, name, color_hex)",
+            kFtsInsertTrigger, kFtsDeleteTrigger, kFtsUpdateTrigger,
+            "INSERT INTO assignments_fts(assignments_fts) VALUES ('rebuild')",
+        }, true},
+        {7, "recurring assignments", {
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS assignment_series(
+              id INTEGER PRIMARY KEY AUTOINCREMENT,
+              course_id INTEGER NOT NULL REFERENCES courses(id) ON DELETE CASCADE,
+              type TEXT NOT NULL,
+              title TEXT NOT NULL,
+              topics TEXT NULL,
+              notes TEXT NULL,
+              first_due_utc INTEGER NOT NULL,
+              interval_weeks INTEGER NOT NULL DEFAULT 1 CHECK(interval_weeks >= 1),
+              until_utc INTEGER NULL,
+              max_count INTEGER NULL,
+              duration_min INTEGER NOT NULL DEFAULT 0,
+              tzid TEXT NOT NULL DEFAULT ''
+            );
+            )SQL",
+            "CREATE INDEX IF NOT EXISTS idx_series_course ON assignment_series(course_id)",
+            // Occurrences skipped by expansion: deleted, or edited into their own assignments row
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS series_exceptions(
+              series_id INTEGER NOT NULL REFERENCES assignment_series(id) ON DELETE CASCADE,
+              occurrence INTEGER NOT NULL,
+              PRIMARY KEY(series_id, occurrence)
+            ) WITHOUT ROWID;
+            )SQL",
+        }},
+        {8, "semester archive flag", {
+            // Set once a term's rows live in the archive file (see archiveSemester)
+            "ALTER TABLE semesters ADD COLUMN archived INTEGER NOT NULL DEFAULT 0",
+        }},
+        {9, "sync change log", {
+            // Stable row identity across devices; semesters match on (term, year) and users on username.
+            "ALTER TABLE courses ADD COLUMN uid TEXT NULL",
+            "ALTER TABLE assignments ADD COLUMN uid TEXT NULL",
+            "ALTER TABLE assignment_series ADD COLUMN uid TEXT NULL",
+            "UPDATE courses SET uid = lower(hex(randomblob(16))) WHERE uid IS NULL",
+            "UPDATE assignments SET uid = lower(hex(randomblob(16))) WHERE uid IS NULL",
+            "UPDATE assignment_series SET uid = lower(hex(randomblob(16))) WHERE uid IS NULL",
+            "CREATE UNIQUE INDEX IF NOT EXISTS idx_courses_uid ON courses(uid)",
+            "CREATE UNIQUE INDEX IF NOT EXISTS idx_assignments_uid ON assignments(uid)",
+            "CREATE UNIQUE INDEX IF NOT EXISTS idx_series_uid ON assignment_series(uid)",
+            // 'device' names this database in batches; 'recv:<device>' is the last batch applied from a peer
+            "CREATE TABLE IF NOT EXISTS sync_state(key TEXT PRIMARY KEY, value NOT NULL) WITHOUT ROWID",
+            "INSERT OR IGNORE INTO sync_state(key, value) VALUES ('applying', 0), ('device', lower(hex(randomblob(8))))",
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS change_log(
+              seq INTEGER PRIMARY KEY AUTOINCREMENT,
+              tbl TEXT NOT NULL,
+              uid TEXT NOT NULL,
+              op TEXT NOT NULL CHECK(op IN ('upsert','delete'))
+            );
+            )SQL",
+            // Last writer per row (ms since epoch, device id breaks ties)
+            R"SQL(
+            CREATE TABLE IF NOT EXISTS sync_clock(
+              tbl TEXT NOT NULL,
+              uid TEXT NOT NULL,
+              changed_at INTEGER NOT NULL,
+              device TEXT NOT NULL,
+              PRIMARY KEY(tbl, uid)
+            ) WITHOUT ROWID;
+            )SQL",
+            CP_SYNC_TRIGGERS("courses"),
+            CP_SYNC_TRIGGERS("assignments"),
+            CP_SYNC_TRIGGERS("assignment_series"),
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS semesters_sync_ai AFTER INSERT ON semesters WHEN )SQL" CP_SYNC_LOCAL R"SQL( BEGIN
+              INSERT INTO change_log(tbl, uid, op) VALUES ('semesters', new.term || ' ' || new.year, 'upsert');
+              INSERT OR REPLACE INTO sync_clock(tbl, uid, changed_at, device)
+              VALUES ('semesters', new.term || ' ' || new.year, 0, (SELECT value FROM sync_state WHERE key = 'device'));
+            END;
+            )SQL",
+            // Exceptions are keyed '<series uid>:<occurrence>'; the ones a series delete cascades away are not logged
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS series_exceptions_sync_ai AFTER INSERT ON series_exceptions WHEN )SQL" CP_SYNC_LOCAL R"SQL( BEGIN
+              INSERT INTO change_log(tbl, uid, op)
+              SELECT 'series_exceptions', uid || ':' || new.occurrence, 'upsert' FROM assignment_series WHERE id = new.series_id AND uid IS NOT NULL;
+              INSERT OR REPLACE INTO sync_clock(tbl, uid, changed_at, device)
+              SELECT 'series_exceptions', uid || ':' || new.occurrence, CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER),
+                     (SELECT value FROM sync_state WHERE key = 'device')
+              FROM assignment_series WHERE id = new.series_id AND uid IS NOT NULL;
+            END;
+            )SQL",
+            // Everything that predates the log goes out with the first sync, older than any edit
+            "INSERT INTO change_log(tbl, uid, op) SELECT 'semesters', term || ' ' || year, 'upsert' FROM semesters WHERE archived = 0",
+            "INSERT INTO change_log(tbl, uid, op) SELECT 'courses', uid, 'upsert' FROM courses",
+            "INSERT INTO change_log(tbl, uid, op) SELECT 'assignment_series', uid, 'upsert' FROM assignment_series",
+            "INSERT INTO change_log(tbl, uid, op) SELECT 'assignments', uid, 'upsert' FROM assignments",
+            R"SQL(
+            INSERT INTO change_log(tbl, uid, op)
+            SELECT 'series_exceptions', s.uid || ':' || e.occurrence, 'upsert' FROM series_exceptions e JOIN assignment_series s ON s.id = e.series_id;
+            )SQL",
+            R"SQL(
+            INSERT OR IGNORE INTO sync_clock(tbl, uid, changed_at, device)
+            SELECT tbl, uid, 0, (SELECT value FROM sync_state WHERE key = 'device') FROM change_log;
+            )SQL",
+        }},
+        {10, "effort estimates", {
+            // Expected hours of work; NULL falls back to the type's typical effort (see WorkloadPriority)
+            "ALTER TABLE assignments ADD COLUMN effort_hours REAL NULL",
+            "ALTER TABLE assignment_series ADD COLUMN effort_hours REAL NULL",
+        }},
+        {11, "assignment owner", {
+            // Copy of courses.user_id, so per-user scans range over one index instead of joining courses
+            "ALTER TABLE assignments ADD COLUMN user_id INTEGER NULL",
+            "UPDATE assignments SET user_id = (SELECT user_id FROM courses WHERE id = assignments.course_id)",
+            "CREATE INDEX IF NOT EXISTS idx_assignments_user_due ON assignments(user_id, due_at_utc)",
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS assignments_owner_ai AFTER INSERT ON assignments WHEN new.user_id IS NULL BEGIN
+              UPDATE assignments SET user_id = (SELECT user_id FROM courses WHERE id = new.course_id) WHERE id = new.id;
+            END;
+            )SQL",
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS assignments_owner_au AFTER UPDATE OF course_id ON assignments BEGIN
+              UPDATE assignments SET user_id = (SELECT user_id FROM courses WHERE id = new.course_id) WHERE id = new.id;
+            END;
+            )SQL",
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS courses_owner_au AFTER UPDATE OF user_id ON courses BEGIN
+              UPDATE assignments SET user_id = new.user_id WHERE course_id = new.id;
+            END;
+            )SQL",
+        }},
+        {12, "series full-text search", {
+            // Same shape as assignments_fts, so one query can rank both
+            R"SQL(
+            CREATE VIRTUAL TABLE IF NOT EXISTS series_fts USING fts5(
+              title, topics, notes,
+              content='assignment_series', content_rowid='id',
+              tokenize='unicode61 remove_diacritics 2'
+            );
+            )SQL",
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS series_fts_ai AFTER INSERT ON assignment_series BEGIN
+              INSERT INTO series_fts(rowid, title, topics, notes) VALUES (new.id, new.title, new.topics, new.notes);
+            END;
+            )SQL",
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS series_fts_ad AFTER DELETE ON assignment_series BEGIN
+              INSERT INTO series_fts(series_fts, rowid, title, topics, notes) VALUES ('delete', old.id, old.title, old.topics, old.notes);
+            END;
+            )SQL",
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS series_fts_au AFTER UPDATE OF title, topics, notes ON assignment_series BEGIN
+              INSERT INTO series_fts(series_fts, rowid, title, topics, notes) VALUES ('delete', old.id, old.title, old.topics, old.notes);
+              INSERT INTO series_fts(rowid, title, topics, notes) VALUES (new.id, new.title, new.topics, new.notes);
+            END;
+            )SQL",
+            "INSERT INTO series_fts(series_fts) VALUES ('rebuild')",
+        }},
+        {13, "sync capture fixes", {
+            // The user_id copy kept by the owner triggers is derived, not synced: an update that changes
+            // nothing else is not a change to log.
+            "DROP TRIGGER IF EXISTS assignments_sync_au",
+            "CREATE TRIGGER IF NOT EXISTS assignments_sync_au AFTER UPDATE ON assignments WHEN old.uid IS NOT NULL AND " CP_SYNC_LOCAL
+            " AND (old.course_id, old.type, old.title, old.due_at_utc, old.topics, old.notes, old.start_at_utc, old.duration_min, old.effort_hours, old.uid)"
+            " IS NOT (new.course_id, new.type, new.title, new.due_at_utc, new.topics, new.notes, new.start_at_utc, new.duration_min, new.effort_hours, new.uid)"
+            " BEGIN" CP_SYNC_STAMP("assignments", "uid") " END",
+            // Local semester inserts are stamped with the time they happened, like every other table
+            "DROP TRIGGER IF EXISTS semesters_sync_ai",
+            R"SQL(
+            CREATE TRIGGER IF NOT EXISTS semesters_sync_ai AFTER INSERT ON semesters WHEN )SQL" CP_SYNC_LOCAL R"SQL( BEGIN
+              INSERT INTO change_log(tbl, uid, op) VALUES ('semesters', new.term || ' ' || new.year, 'upsert');
+              INSERT OR REPLACE INTO sync_clock(tbl, uid, changed_at, device)
+              VALUES ('semesters', new.term || ' ' || new.year, CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER),
+                      (SELECT value FROM sync_state WHERE key = 'device'));
+            END;
+            )SQL",
+        }},
+    };
+    return steps;
+}
+
+static int latestSchemaVersion() { return migrationSteps().back().version; }
+
+static int schemaVersion(QSqlDatabase& db) {
+    QSqlQuery q(db);
+    return q.exec("PRAGMA user_version") && q.next() ? q.value(0).toInt() : -1;
+}
+
+static bool runMigrations(QSqlDatabase& db) {
+    int current = schemaVersion(db);
+    if (current < 0) return false;
+    int previous = 0;
+    for (const auto& step : migrationSteps()) {
+        Q_ASSERT(step.version > previous);  // steps must stay in version order
+        previous = step.version;
+        if (step.version <= current) continue;
+        QSqlQuery q(db);
+        // foreign_keys is a no-op inside a transaction, so it is toggled around it
+        if (step.rebuildsTables) q.exec("PRAGMA foreign_keys=OFF");
+        if (!db.transaction()) return false;
+        bool ok = true;
+        for (const char* sql : step.sql) {
+            if (!q.exec(QString::fromUtf8(sql))) { ok = false; break; }
+        }
+        if (ok && step.rebuildsTables) ok = q.exec("PRAGMA foreign_key_check") && !q.next();
+        ok = ok && q.exec(QString("PRAGMA user_version = %1").arg(step.version));
+        if (!ok || !db.commit()) {
+            qWarning() << "Migration" << step.version << step.name << "failed:" << q.lastError().text();
+            db.rollback();
+            if (step.rebuildsTables) q.exec("PRAGMA foreign_keys=ON");
+            return false;
+        }
+        if (step.rebuildsTables) q.exec("PRAGMA foreign_keys=ON");
+        current = step.version;
+    }
+    return true;
+}
+
+// Resident set size of this process in bytes, or -1 where unknown.
+static qint64 residentBytes() {
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc) ? qint64(pmc.WorkingSetSize) : -1;
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    return task_info(mach_task_self(), MACH_TASK_BASIC_INFO, task_info_t(&info), &count) == KERN_SUCCESS ? qint64(info.resident_size) : -1;
+#else
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:")) return line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;  // "VmRSS:  1234 kB"
+    }
+    return -1;
+#endif
+}
+
+// Query and view metrics (Debug > Diagnostics). Each SQL text gets a log2
+// latency histogram in microseconds plus returned/changed row and error
+// counts; named timings cover transactions and view rebuilds. Collection is
+// off unless [diagnostics] metrics=true or COURSEPILOT_METRICS=1, and while
+// off an exec pays one relaxed atomic load. Rows *scanned* are not exposed
+// by Qt's SQLite driver; the dialog shows EXPLAIN QUERY PLAN instead.
+class Metrics {
+public:
+    static constexpr int kBuckets = 24;  // [0,1us), [1,2us), [2,4us) ... [2^22us, inf)
+
+    struct Histogram {
+        std::array<std::atomic<quint64>, kBuckets> buckets{};
+        std::atomic<quint64> count{0}, totalNs{0}, maxNs{0};
+
+        void add(qint64 ns) {
+            const auto n = quint64(std::max<qint64>(ns, 0));
+            buckets[std::size_t(std::min<int>(kBuckets - 1, int(std::bit_width(n / 1000))))].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            totalNs.fetch_add(n, std::memory_order_relaxed);
+            for (quint64 m = maxNs.load(std::memory_order_relaxed); n > m && !maxNs.compare_exchange_weak(m, n, std::memory_order_relaxed);) {}
+        }
+        // Upper bound of the bucket holding quantile q, in microseconds.
+        quint64 quantileUs(double q) const {
+            const quint64 total = count.load(std::memory_order_relaxed);
+            if (!total) return 0;
+            const auto want = std::max<quint64>(1, quint64(std::ceil(q * double(total))));
+            quint64 seen = 0;
+            for (int i = 0; i < kBuckets; ++i)
+                if ((seen += buckets[std::size_t(i)].load(std::memory_order_relaxed)) >= want) return quint64(1) << i;
+            return quint64(1) << (kBuckets - 1);
+        }
+        void clear() {
+            for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+            count.store(0); totalNs.store(0); maxNs.store(0);
+        }
+        QJsonObject toJson() const {
+            const quint64 n = count.load();
+            QJsonArray hist;
+            for (const auto& b : buckets) hist.append(double(b.load()));
+            return {{"count", double(n)}, {"total_ns", double(totalNs.load())}, {"mean_ns", n ? double(totalNs.load()) / double(n) : 0.0},
+                    {"p50_us", double(quantileUs(0.5))}, {"p95_us", double(quantileUs(0.95))}, {"p99_us", double(quantileUs(0.99))},
+                    {"max_ns", double(maxNs.load())}, {"histogram_log2_us", hist}};
+        }
+    };
+
+    struct Statement {
+        QString sql;
+        Histogram latency;  // exec plus row fetch, up to finish()
+        std::atomic<quint64> rows{0}, changed{0}, errors{0};
+    };
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+    static Metrics& instance() { static Metrics m; return m; }
+
+    // Stable for the process lifetime, so statement caches keep the pointer.
+    Statement* statement(const QString& sql) {
+        QMutexLocker lock(&mutex_);
+        auto& slot = statements_[sql];
+        if (!slot) { slot = std::make_unique<Statement>(); slot->sql = sql; }
+        return slot.get();
+    }
+    void time(const char* name, qint64 ns) {
+        QMutexLocker lock(&mutex_);
+        auto& slot = timings_[QLatin1String(name)];
+        if (!slot) slot = std::make_unique<Histogram>();
+        slot->add(ns);
+    }
+
+    // Times its scope into a named timing when metrics are on.
+    class Scope {
+    public:
+        explicit Scope(const char* name) : name_(enabled() ? name : nullptr) { if (name_) timer_.start(); }
+        ~Scope() { if (name_) instance().time(name_, timer_.nsecsElapsed()); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        const char* name_;
+        QElapsedTimer timer_;
+    };
+
+    template <class F> void forEachStatement(F f) const {
+        QMutexLocker lock(&mutex_);
+        for (const auto& [sql, st] : statements_) f(*st);
+    }
+    template <class F> void forEachTiming(F f) const {
+        QMutexLocker lock(&mutex_);
+        for (const auto& [name, h] : timings_) f(name, *h);
+    }
+
+    void clear() {
+        QMutexLocker lock(&mutex_);
+        for (auto& [sql, st] : statements_) { st->latency.clear(); st->rows.store(0); st->changed.store(0); st->errors.store(0); }
+        for (auto& [name, h] : timings_) h->clear();
+    }
+
+    QJsonObject toJson() const {
+        QJsonArray statements, timings;
+        forEachStatement([&](const Statement& st) {
+            if (!st.latency.count.load() && !st.errors.load()) return;
+            QJsonObject o = st.latency.toJson();
+            o.insert("sql", st.sql.simplified());
+            o.insert("rows", double(st.rows.load()));
+            o.insert("changed", double(st.changed.load()));
+            o.insert("errors", double(st.errors.load()));
+            statements.append(o);
+        });
+        forEachTiming([&](const QString& name, const Histogram& h) {
+            QJsonObject o = h.toJson();
+            o.insert("name", name);
+            timings.append(o);
+        });
+        return {{"enabled", enabled()}, {"statements", statements}, {"timings", timings}};
+    }
+
+private:
+    static inline std::atomic<bool> enabled_{false};
+    mutable QMutex mutex_;
+    std::map<QString, std::unique_ptr<Statement>> statements_;
+    std::map<QString, std::unique_ptr<Histogram>> timings_;
+};
+
+// Prepared-statement cache over one connection. Each distinct SQL text is
+// prepared once and then rebound/re-executed; migrate() drops every cached
+// statement around schema changes so nothing runs against a stale plan.
+class SqlRepo {
+public:
+    // Finishes (resets) the cached statement when it goes out of scope, so a
+    // half-read SELECT never keeps its read lock. One cursor per SQL shape at a time.
+    // Read rows through next() so metrics see them.
+    class Cursor {
+    public:
+        explicit Cursor(QSqlQuery* q = nullptr, Metrics::Statement* stats = nullptr, qint64 execNs = 0)
+            : q_(q), stats_(stats), ns_(execNs) {}
+        Cursor(Cursor&& o) noexcept
+            : q_(std::exchange(o.q_, nullptr)), stats_(std::exchange(o.stats_, nullptr)), ns_(o.ns_), rows_(o.rows_) {}
+        Cursor& operator=(Cursor&&) = delete;
+        ~Cursor() {
+            if (!q_) return;
+            q_->finish();
+            if (stats_) { stats_->latency.add(ns_); stats_->rows.fetch_add(rows_, std::memory_order_relaxed); }
+        }
+        explicit operator bool() const { return q_ != nullptr; }
+        QSqlQuery* operator->() const { return q_; }
+        bool next() {
+            if (!stats_) return q_->next();
+            QElapsedTimer t;
+            t.start();
+            const bool more = q_->next();
+            ns_ += t.nsecsElapsed();
+            rows_ += more;
+            return more;
+        }
+    private:
+        QSqlQuery* q_;
+        Metrics::Statement* stats_;  // null while metrics are off
+        qint64 ns_;
+        quint64 rows_ = 0;
+    };
+
+    explicit SqlRepo(QString connection = QLatin1String(QSqlDatabase::defaultConnection)) : connection_(std::move(connection)) {}
+    SqlRepo(const SqlRepo&) = delete;
+    SqlRepo& operator=(const SqlRepo&) = delete;
+    ~SqlRepo() { if (ui_ == this) ui_ = nullptr; }
+
+    // Repo used by dialogs and MainWindow slots on the GUI thread
+    static SqlRepo& ui() { Q_ASSERT(ui_); return *ui_; }
+    static void setUi(SqlRepo* r) { ui_ = r; }
+
+    QSqlDatabase& db() { return db_; }
+    const QString& connectionName() const { return connection_; }
+    bool open() { return ensureDbOpen(db_, connection_); }
+    bool openArchive() { return ensureDbOpen(db_, connection_, archivePath(), true); }
+    // Drops cached statements and the connection; the repo is unusable afterwards.
+    void close() {
+        invalidate();
+        db_.close();
+        db_ = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connection_);
+    }
+    bool migrate() {
+        // Fast path for every launch after the first: one PRAGMA read, no DDL.
+        if (schemaVersion(db_) == latestSchemaVersion()) return true;
+        invalidate();
+        const bool ok = runMigrations(db_);
+        invalidate();
+        return ok;
+    }
+    void invalidate() { cache_.clear(); }
+    // Error of the most recent failed exec(), for busy detection.
+    const QSqlError& lastError() const { return lastError_; }
+    void clearLastError() { lastError_ = QSqlError(); }
+
+    // Binds args positionally and executes; an empty Cursor means failure.
+    Cursor exec(const QString& sql, const QVariantList& args = {}) {
+        const bool timed = Metrics::enabled();
+        QElapsedTimer t;
+        if (timed) t.start();
+        auto& slot = cache_[sql];
+        if (!slot.query) {
+            auto q = std::make_shared<QSqlQuery>(db_);
+            q->setForwardOnly(true);
+            if (!q->prepare(sql)) {
+                lastError_ = q->lastError();
+                qWarning() << "prepare failed:" << lastError_.text() << sql;
+                Metrics::instance().statement(sql)->errors.fetch_add(1, std::memory_order_relaxed);
+                cache_.remove(sql);
+                return Cursor{};
+            }
+            slot = {std::move(q), Metrics::instance().statement(sql)};
+        }
+        QSqlQuery* q = slot.query.get();
+        for (qsizetype i = 0; i < args.size(); ++i) q->bindValue(int(i), args[i]);
+        if (!q->exec()) {
+            lastError_ = q->lastError();
+            qWarning() << "exec failed:" << lastError_.text() << sql;
+            slot.stats->errors.fetch_add(1, std::memory_order_relaxed);
+            q->finish();
+            return Cursor{};
+        }
+        if (!timed) return Cursor{q};
+        if (!q->isSelect()) slot.stats->changed.fetch_add(quint64(std::max(0, q->numRowsAffected())), std::memory_order_relaxed);
+        return Cursor{q, slot.stats, t.nsecsElapsed()};
+    }
+
+private:
+    struct Prepared {
+        std::shared_ptr<QSqlQuery> query;
+        Metrics::Statement* stats = nullptr;
+    };
+    QString connection_;
+    QSqlDatabase db_;
+    QHash<QString, Prepared> cache_;
+    QSqlError lastError_;
+    static inline SqlRepo* ui_ = nullptr;
+};
+
+// Write contention: several sessions may share one coursepilot.db (lab
+// machines on shared storage). busy_timeout absorbs short waits inside
+// SQLite; writeTransaction takes the write lock up front with BEGIN
+// IMMEDIATE, since a deferred transaction that upgrades to a writer can get
+// SQLITE_BUSY without the busy handler ever running, and re-runs the whole
+// body with jittered exponential backoff when the lock stays taken.
+struct ContentionStats {
+    std::atomic<quint64> transactions{0}, retries{0}, failures{0}, backoffMs{0};
+
+    static ContentionStats& instance() { static ContentionStats s; return s; }
+    QString summary() const {
+        return QString("Write transactions: %1\nBusy retries: %2\nGave up: %3\nTime in backoff: %4 ms")
+            .arg(transactions.load()).arg(retries.load()).arg(failures.load()).arg(backoffMs.load());
+    }
+};
+
+static bool isBusyError(const QSqlError& e) {
+    bool ok = false;
+    const int code = e.nativeErrorCode().toInt(&ok) & 0xff;  // extended codes keep the primary in the low byte
+    return ok && (code == 5 /* SQLITE_BUSY */ || code == 6 /* SQLITE_LOCKED */);
+}
+
+static constexpr int kWriteAttempts = 6;
+
+// The retry backoff sleeps, so this must never run on the GUI thread; post
+// the write to DbWorker instead. The CLI and bench modes have no event loop
+// to stall and may call it from their main thread.
+static bool onGuiThread() {
+    return qobject_cast<QApplication*>(QCoreApplication::instance())
+        && QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+
+// body() returns false on failure and must be safe to run again from scratch.
+template <class F>
+static bool writeTransaction(SqlRepo& repo, F body) {
+    if (onGuiThread()) {
+        Q_ASSERT_X(false, "writeTransaction", "called on the GUI thread");
+        qCritical() << "writeTransaction called on the GUI thread; refusing to block it";
+        return false;
+    }
+    auto& stats = ContentionStats::instance();
+    stats.transactions.fetch_add(1, std::memory_order_relaxed);
+    Metrics::Scope total("tx.total");  // including retries and backoff
+    for (int attempt = 1;; ++attempt) {
+        bool busy = false;
+        repo.clearLastError();
+        if (repo.exec("BEGIN IMMEDIATE")) {
+            if (body()) {
+                Metrics::Scope commit("tx.commit");
+                if (repo.exec("COMMIT")) return true;
+            }
+            busy = isBusyError(repo.lastError());
+            repo.exec("ROLLBACK");
+        } else {
+            busy = isBusyError(repo.lastError());
+        }
+        if (!busy || attempt == kWriteAttempts) {
+            if (busy) stats.failures.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const int base = std::min(10 << attempt, 500);
+        const int delay = base + int(QRandomGenerator::global()->bounded(base / 2 + 1));
+        stats.retries.fetch_add(1, std::memory_order_relaxed);
+        stats.backoffMs.fetch_add(quint64(delay), std::memory_order_relaxed);
+        QThread::msleep(delay);
+    }
+}
+
+// Password hashing: PBKDF2-HMAC-SHA256 with a per-user random salt. The
+// algorithm and cost are stored next to the hash so the cost can be raised
+// later; rows still on the legacy unsalted SHA-256 are rehashed on login.
+// Deliberately slow, so callers run it on a pool thread.
+static constexpr auto kKdfLegacy = "sha256";
+static constexpr auto kKdfPbkdf2 = "pbkdf2-sha256";
+static constexpr int kDefaultKdfIterations = 310000;
+static constexpr int kMinKdfIterations = 10000;
+
+struct PasswordHash {
+    QString algo;
+    QByteArray salt;
+    int iterations = 0;
+    QByteArray hash;
+};
+
+static int configuredKdfIterations() {
+    const QSettings s(settingsPath(), QSettings::IniFormat);
+    return std::max(kMinKdfIterations, s.value("security/pbkdf2_iterations", kDefaultKdfIterations).toInt());
+}
+
+// RFC 8018 PBKDF2 with a single 32-byte output block (dkLen == hLen).
+static QByteArray pbkdf2Sha256(const QByteArray& password, const QByteArray& salt, int iterations) {
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+    mac.addData(salt);
+    mac.addData(QByteArrayView("\0\0\0\1", 4));
+    QByteArray u = mac.result();
+    QByteArray t = u;
+    for (int i = 1; i < iterations; ++i) {
+        mac.reset();
+        mac.addData(u);
+        u = mac.result();
+        for (qsizetype j = 0; j < t.size(); ++j) t[j] = char(t[j] ^ u[j]);
+    }
+    return t;
+}
+
+static PasswordHash hashPassword(const QString& pw, int iterations = configuredKdfIterations()) {
+    PasswordHash h{kKdfPbkdf2, QByteArray(16, Qt::Uninitialized), iterations, {}};
+    QRandomGenerator::system()->generate(reinterpret_cast<quint32*>(h.salt.data()),
+                                         reinterpret_cast<quint32*>(h.salt.data() + h.salt.size()));
+    h.hash = pbkdf2Sha256(pw.toUtf8(), h.salt, iterations);
+    return h;
+}
+
+static bool constantTimeEquals(const QByteArray& a, const QByteArray& b) {
+    if (a.size() != b.size()) return false;
+    unsigned char diff = 0;
+    for (qsizetype i = 0; i < a.size(); ++i) diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+    return diff == 0;
+}
+
+static bool verifyPassword(const QString& pw, const PasswordHash& stored) {
+    if (stored.algo == QLatin1String(kKdfPbkdf2))
+        return constantTimeEquals(pbkdf2Sha256(pw.toUtf8(), stored.salt, stored.iterations), stored.hash);
+    if (stored.algo == QLatin1String(kKdfLegacy))
+        return constantTimeEquals(QCryptographicHash::hash(pw.toUtf8(), QCryptographicHash::Sha256), stored.hash);
+    return false;
+}
+
+static bool needsRehash(const PasswordHash& stored, int iterations) {
+    return stored.algo != QLatin1String(kKdfPbkdf2) || stored.iterations < iterations;
+}
+
+// Cost calibration: iterations that take about `targetMs` on this machine.
+static int calibrateKdfIterations(int targetMs) {
+    const QByteArray pw("calibration"), salt(16, 'x');
+    int probe = 20000;
+    qint64 ns = 0;
+    for (;;) {
+        QElapsedTimer t;
+        t.start();
+        pbkdf2Sha256(pw, salt, probe);
+        ns = t.nsecsElapsed();
+        if (ns >= 50'000'000 || probe >= 1 << 26) break;  // measure at least 50 ms
+        probe *= 2;
+    }
+    const double perMs = probe / (std::max<qint64>(ns, 1) / 1e6);
+    return std::max(kMinKdfIterations, int(perMs * targetMs / 1000) * 1000);
+}
+
+struct LoginResult {
+    int userId = -1;
+    QString error;
+};
+
+// Runs on a pool connection: lookup, verify, and upgrade the stored hash if needed.
+static LoginResult loginUser(SqlRepo& repo, const QString& username, const QString& pw, int iterations) {
+    PasswordHash stored;
+    int id = -1;
+    if (auto q = repo.exec("SELECT id, password_hash, password_algo, password_salt, password_iter FROM users WHERE username = ?", {username});
+        q && q.next()) {
+        id = q->value(0).toInt();
+        stored = {q->value(2).toString(), q->value(3).toByteArray(), q->value(4).toInt(), q->value(1).toByteArray()};
+    }
+    if (id < 0) return {-1, "User not found."};
+    if (!verifyPassword(pw, stored)) return {-1, "Incorrect password."};
+    if (needsRehash(stored, iterations)) {
+        const auto h = hashPassword(pw, iterations);
+        if (!writeTransaction(repo, [&] {
+                return bool(repo.exec("UPDATE users SET password_hash=?, password_algo=?, password_salt=?, password_iter=? WHERE id=?",
+                                      {h.hash, h.algo, h.salt, h.iterations, id}));
+            }))
+            qWarning() << "Password rehash failed for user" << id;
+    }
+    return {id, {}};
+}
+
+static QString registerUser(SqlRepo& repo, const QString& username, const QString& pw, int iterations) {
+    const auto h = hashPassword(pw, iterations);
+    const bool ok = writeTransaction(repo, [&] {
+        return bool(repo.exec("INSERT INTO users(username, password_hash, password_algo, password_salt, password_iter, created_at) VALUES(?,?,?,?,?,?)",
+                              {username, h.hash, h.algo, h.salt, h.iterations, QDateTime::currentSecsSinceEpoch()}));
+    });
+    if (!ok) return isBusyError(repo.lastError()) ? "The database is busy; try again." : "Username exists?";
+    return {};
+}
+
+// Series matching `where` (over s = assignment_series, c = courses), each
+// with its sorted skipped indexes.
+static std::vector<AssignmentSeries> fetchSeries(SqlRepo& repo, const char* where, const QVariantList& args) {
+    std::vector<AssignmentSeries> out;
+    QHash<QString, QTimeZone> zones;  // zone lookups hit the tz database
+    if (auto q = repo.exec(QString(R"(SELECT s.id, s.course_id, s.type, s.title, s.topics, s.notes, s.first_due_utc, s.interval_weeks,
+                                             s.until_utc, s.max_count, s.duration_min, s.tzid, s.effort_hours, e.occurrence
+                                      FROM assignment_series s
+                                      JOIN courses c ON c.id = s.course_id
+                                      LEFT JOIN series_exceptions e ON e.series_id = s.id
+                                      WHERE %1
+                                      ORDER BY s.id, e.occurrence)").arg(QLatin1String(where)), args)) while (q.next()) {
+        if (out.empty() || out.back().id != q->value(0).toInt()) {
+            AssignmentSeries& s = out.emplace_back();
+            s.id = q->value(0).toInt();
+            s.courseId = q->value(1).toInt();
+            s.type = parseAssignType(q->value(2).toString());
+            s.title = q->value(3).toString();
+            if (!q->value(4).isNull()) s.topics = q->value(4).toString();
+            if (!q->value(5).isNull()) s.notes = q->value(5).toString();
+            s.firstDueUtc = q->value(6).toLongLong();
+            s.intervalWeeks = std::max(1, q->value(7).toInt());
+            if (!q->value(8).isNull()) s.untilUtc = q->value(8).toLongLong();
+            s.count = q->value(9).toInt();
+            s.durationMin = q->value(10).toInt();
+            s.effortHours = q->value(12).toDouble();
+            if (const QString tzid = q->value(11).toString(); !tzid.isEmpty()) {
+                auto zone = zones.find(tzid);
+                if (zone == zones.end()) zone = zones.insert(tzid, QTimeZone(tzid.toUtf8()));
+                if (zone->isValid()) s.zone = *zone;
+            }
+        }
+        if (!q->value(13).isNull()) out.back().skipped.push_back(q->value(13).toInt());
+    }
+    return out;
+}
+
+// Upcoming deadlines: the due filter and LIMIT are pushed into SQLite so only
+// K rows ever leave the DB; BoundedTopK keeps the result bounded regardless.
+// `after` continues a previous page in (due_at_utc, id) order.
+static std::vector<Assignment> fetchUpcoming(SqlRepo& repo, int userId, int semesterId, qint64 nowUtc, int k,
+                                             DueKey after = {std::numeric_limits<qint64>::min(), std::numeric_limits<int>::min()}) {
+    if (k <= 0) return {};
+    AssignmentStore store;
+    store.reserve(std::size_t(k));
+    // idx_assignments_user_due yields the user's rows in (due, id) order, so nothing is sorted. The
+    // semester filter is only checked per row after the seek: the scan stops at the K-th match, but
+    // steps over any of the user's rows from other semesters that fall due before it.
+    if (auto q = repo.exec(R"(SELECT a.id, a.course_id, a.type, a.title, a.due_at_utc, a.topics
+                              FROM assignments a
+                              WHERE a.user_id = ? AND a.due_at_utc >= ? AND (a.due_at_utc, a.id) > (?, ?)
+                                AND a.course_id IN (SELECT id FROM courses WHERE user_id = ? AND semester_id = ?)
+                              ORDER BY a.due_at_utc, a.id
+                              LIMIT ?)", {userId, nowUtc, after.first, after.second, userId, semesterId, k})) while (q.next()) {
+        store.upsert(q->value(0).toInt(), q->value(1).toInt(), parseAssignType(q->value(2).toString()),
+                     q->value(4).toLongLong(), q->value(3).toString(), q->value(5).toString());
+    }
+    // Each live series contributes at most K occurrences to the same selection.
+    std::vector<Assignment> occurrences;
+    const DueKey from = std::max(after, DueKey{nowUtc, std::numeric_limits<int>::min()});
+    for (const auto& s : fetchSeries(repo, "c.semester_id = ? AND c.user_id = ? AND (s.until_utc IS NULL OR s.until_utc >= ?)",
+                                     {semesterId, userId, nowUtc}))
+        expandSeries(s, from, std::size_t(k), std::numeric_limits<qint64>::max(), occurrences);
+    for (const auto& a : occurrences) store.upsert(a);
+    // Selection runs over the packed columns; only the K winners become Assignments.
+    BoundedTopK<AssignmentStore::Row, StoreDueSooner> top(static_cast<std::size_t>(k), StoreDueSooner{&store});
+    for (AssignmentStore::Row r = 0; r < store.size(); ++r) top.push(r);
+    std::vector<Assignment> out;
+    out.reserve(top.size());
+    for (auto r : top.takeSorted()) out.push_back(store.materialize(r));
+    return out;
+}
+
+// Most urgent first: unlike the due order no SQL LIMIT applies, so every open
+// item of the semester is loaded and scored as one batch. A series' later
+// occurrences never outscore its earlier ones, so K per series suffice; the
+// rest still count towards their course's load through countFrom().
+static std::vector<Assignment> fetchUrgent(SqlRepo& repo, int userId, int semesterId, qint64 nowUtc, int k,
+                                           const PriorityModel& model) {
+    if (k <= 0) return {};
+    AssignmentStore store;
+    if (auto q = repo.exec(R"(SELECT a.id, a.course_id, a.type, a.title, a.due_at_utc, a.topics, a.effort_hours
+                              FROM assignments a
+                              WHERE a.user_id = ? AND a.due_at_utc >= ?
+                                AND a.course_id IN (SELECT id FROM courses WHERE user_id = ? AND semester_id = ?))",
+                           {userId, nowUtc, userId, semesterId})) while (q.next()) {
+        store.upsert(q->value(0).toInt(), q->value(1).toInt(), parseAssignType(q->value(2).toString()),
+                     q->value(4).toLongLong(), q->value(3).toString(), q->value(5).toString(),
+                     AssignmentStore::kNoStart, 0, float(q->value(6).toDouble()));
+    }
+    std::vector<Assignment> occurrences;
+    QHash<int, int> moreOpen;
+    for (const auto& s : fetchSeries(repo, "c.semester_id = ? AND c.user_id = ? AND (s.until_utc IS NULL OR s.until_utc >= ?)",
+                                     {semesterId, userId, nowUtc})) {
+        const std::size_t before = occurrences.size();
+        expandSeries(s, DueKey{nowUtc, std::numeric_limits<int>::min()}, std::size_t(k), std::numeric_limits<qint64>::max(), occurrences);
+        if (const int rest = s.countFrom(nowUtc) - int(occurrences.size() - before); rest > 0) moreOpen[s.courseId] += rest;
+    }
+    for (const auto& a : occurrences) store.upsert(a);
+    std::vector<double> scores;
+    model.score(store, nowUtc, moreOpen, scores);
+    BoundedTopK<AssignmentStore::Row, StoreMoreUrgent> top(static_cast<std::size_t>(k), StoreMoreUrgent{&store, &scores});
+    for (AssignmentStore::Row r = 0; r < store.size(); ++r) top.push(r);
+    std::vector<Assignment> out;
+    out.reserve(top.size());
+    for (auto r : top.takeSorted()) out.push_back(store.materialize(r));
+    return out;
+}
+
+// One row for an edit dialog; a series occurrence id yields that occurrence.
+static std::optional<Assignment> fetchAssignment(SqlRepo& repo, int id) {
+    if (isOccurrenceId(id)) {
+        const auto series = fetchSeries(repo, "s.id = ?", {occurrenceSeries(id)});
+        if (series.empty()) return std::nullopt;
+        return series.front().occurrence(occurrenceIndex(id));
+    }
+    auto q = repo.exec("SELECT course_id, type, title, due_at_utc, topics, notes, start_at_utc, duration_min, effort_hours FROM assignments WHERE id=?", {id});
+    if (!q || !q.next()) return std::nullopt;
+    Assignment a;
+    a.id = id;
+    a.courseId = q->value(0).toInt();
+    a.type = parseAssignType(q->value(1).toString());
+    a.title = q->value(2).toString();
+    a.dueAtUtc = QDateTime::fromSecsSinceEpoch(q->value(3).toLongLong()).toUTC();
+    if (!q->value(4).isNull()) a.topics = q->value(4).toString();
+    if (!q->value(5).isNull()) a.notes = q->value(5).toString();
+    if (!q->value(6).isNull()) a.startAtUtc = QDateTime::fromSecsSinceEpoch(q->value(6).toLongLong()).toUTC();
+    a.durationMin = q->value(7).toInt();
+    a.effortHours = q->value(8).toDouble();
+    return a;
+}
+
+// One keyset page of a course's assignments, ordered by (due_at_utc, id).
+// Series occurrences are expanded for the same window and merged in; SQL
+// rows are copied column to column, so only occurrences become Assignments.
+static AssignmentStore fetchAssignmentPage(SqlRepo& repo, int courseId, qint64 afterDue, int afterId, int limit) {
+    AssignmentStore rows; rows.reserve(std::size_t(limit));
+    if (auto q = repo.exec(R"(SELECT id, type, title, due_at_utc, topics
+                              FROM assignments
+                              WHERE course_id=? AND (due_at_utc, id) > (?, ?)
+                              ORDER BY due_at_utc, id LIMIT ?)",
+                           {courseId, afterDue, afterId, limit})) while (q.next()) {
+        rows.upsert(q->value(0).toInt(), courseId, parseAssignType(q->value(1).toString()),
+                    q->value(3).toLongLong(), q->value(2).toString(), q->value(4).toString());
+    }
+    std::vector<Assignment> occurrences;
+    for (const auto& s : fetchSeries(repo, "s.course_id = ?", {courseId}))
+        expandSeries(s, {afterDue, afterId}, std::size_t(limit), std::numeric_limits<qint64>::max(), occurrences);
+    if (occurrences.empty()) return rows;
+    const auto key = [](const Assignment& a) { return DueKey{a.dueAtUtc.toSecsSinceEpoch(), a.id}; };
+    std::sort(occurrences.begin(), occurrences.end(), [&](const Assignment& a, const Assignment& b) { return key(a) < key(b); });
+    AssignmentStore out; out.reserve(std::size_t(limit));
+    AssignmentStore::Row r = 0;
+    for (std::size_t o = 0; int(out.size()) < limit && (r < rows.size() || o < occurrences.size());) {
+        if (o == occurrences.size() || (r < rows.size() && DueKey{rows.due(r), rows.id(r)} < key(occurrences[o]))) out.append(rows, r++);
+        else out.upsert(occurrences[o++]);
+    }
+    return out;
+}
+
+// Last second of a semester in UTC, by the split the CLI uses to pick the
+// current term: Spring runs January-June, Fall July-December (local time).
+static qint64 semesterLastSecond(SqlRepo& repo, int semesterId) {
+    auto q = repo.exec("SELECT term, year FROM semesters WHERE id=?", {semesterId});
+    if (!q || !q.next()) return std::numeric_limits<qint64>::min();
+    const int year = q->value(1).toInt();
+    const QDate end = q->value(0).toString() == "Spring" ? QDate(year, 7, 1) : QDate(year + 1, 1, 1);
+    return QDateTime(end, QTime(0, 0)).toSecsSinceEpoch() - 1;
+}
+
+// Everything in a user's semester that can block time (see scheduleSpan).
+// Series expand up to the semester's end, or further only as far as the
+// latest row here, so every row/occurrence overlap is still found; UNTIL and
+// COUNT cut them shorter as usual.
+static AssignmentStore fetchScheduleItems(SqlRepo& repo, int userId, int semesterId) {
+    AssignmentStore out;
+    qint64 lastDue = semesterLastSecond(repo, semesterId);
+    if (auto q = repo.exec(R"(SELECT a.id, a.course_id, a.type, a.title, a.due_at_utc, a.start_at_utc, a.duration_min
+                              FROM assignments a
+                              WHERE a.user_id = ? AND a.course_id IN (SELECT id FROM courses WHERE user_id = ? AND semester_id = ?)
+                                AND (a.start_at_utc IS NOT NULL OR a.duration_min > 0 OR a.type IN ('Quiz','Midterm','Final')))",
+                           {userId, userId, semesterId})) while (q.next()) {
+        const auto row = out.upsert(q->value(0).toInt(), q->value(1).toInt(), parseAssignType(q->value(2).toString()),
+                                    q->value(4).toLongLong(), q->value(3).toString(), {},
+                                    q->value(5).isNull() ? AssignmentStore::kNoStart : q->value(5).toLongLong(), q->value(6).toInt());
+        if (auto span = out.span(row)) lastDue = std::max(lastDue, span->end - 1);
+    }
+    std::vector<Assignment> occurrences;
+    for (const auto& s : fetchSeries(repo, "c.user_id = ? AND c.semester_id = ? AND (s.duration_min > 0 OR s.type IN ('Quiz','Midterm','Final'))",
+                                     {userId, semesterId}))
+        expandSeries(s, {std::numeric_limits<qint64>::min(), std::numeric_limits<int>::min()}, kMaxOccurrences, lastDue, occurrences);
+    for (const auto& a : occurrences) out.upsert(a);
+    return out;
+}
+
+static std::vector<ConflictIndex::Entry> scheduleEntries(const AssignmentStore& items) {
+    std::vector<ConflictIndex::Entry> out; out.reserve(items.size());
+    for (AssignmentStore::Row r = 0; r < items.size(); ++r)
+        if (auto span = items.span(r)) out.push_back({items.id(r), *span});
+    return out;
+}
+
+// Timeline data: everything of a user's due in [fromUtc, toUtc), across
+// semesters: one range scan on idx_assignments_user_due.
+static AssignmentStore fetchRange(SqlRepo& repo, int userId, qint64 fromUtc, qint64 toUtc) {
+    AssignmentStore out;
+    if (auto q = repo.exec(R"(SELECT a.id, a.course_id, a.type, a.title, a.due_at_utc
+                              FROM assignments a
+                              WHERE a.user_id = ? AND a.due_at_utc BETWEEN ? AND ?)",
+                           {userId, fromUtc, toUtc - 1})) while (q.next()) {
+        out.upsert(q->value(0).toInt(), q->value(1).toInt(), parseAssignType(q->value(2).toString()),
+                   q->value(4).toLongLong(), q->value(3).toString(), {});
+    }
+    std::vector<Assignment> occurrences;
+    for (const auto& s : fetchSeries(repo, "c.user_id = ? AND s.first_due_utc < ? AND (s.until_utc IS NULL OR s.until_utc >= ?)",
+                                     {userId, toUtc, fromUtc}))
+        expandSeries(s, {fromUtc - 1, std::numeric_limits<int>::max()}, kMaxOccurrences, toUtc - 1, occurrences);
+    for (const auto& a : occurrences) out.upsert(a);
+    return out;
+}
+
+struct CourseSwatch { QString code; QColor color; };
+
+// Code and color of every course a user has, for views that span semesters.
+static QHash<int, CourseSwatch> fetchCourseSwatches(SqlRepo& repo, int userId) {
+    QHash<int, CourseSwatch> out;
+    if (auto q = repo.exec("SELECT id, code, color_hex FROM courses WHERE user_id=?", {userId})) while (q.next()) {
+        const QColor color = QColor::fromString(q->value(2).toString());
+        out.insert(q->value(0).toInt(), {q->value(1).toString(), color.isValid() ? color : QColor(0x4F, 0x46, 0xE5)});
+    }
+    return out;
+}
+
+static QVariant nullableText(const std::optional<QString>& s) {
+    return s && !s->isEmpty() ? QVariant(*s) : QVariant(QString());
+}
+
+static std::vector<Course> fetchCourses(SqlRepo& repo, int userId, int semesterId) {
+    std::vector<Course> out;
+    if (auto q = repo.exec("SELECT id, code, name, color_hex FROM courses WHERE user_id=? AND semester_id=?",
+                           {userId, semesterId})) while (q.next())
+        out.push_back(Course{q->value(0).toInt(), userId, semesterId,
+                             q->value(1).toString(), q->value(2).toString(), q->value(3).toString()});
+    return out;
+}
+
+// Inserts when c.id < 0, otherwise updates; returns the row id or -1.
+static int saveCourseRow(SqlRepo& repo, const Course& c) {
+    int id = -1;
+    const bool ok = writeTransaction(repo, [&] {
+        id = -1;
+        if (c.id < 0) {
+            if (auto ins = repo.exec(R"(INSERT INTO courses(user_id, semester_id, code, name, color_hex) VALUES(?,?,?,?,?))",
+                                     {c.userId, c.semesterId, c.code, c.name, c.colorHex}))
+                id = ins->lastInsertId().toInt();
+        } else if (repo.exec(R"(UPDATE courses SET code=?, name=?, color_hex=? WHERE id=?)",
+                             {c.code, c.name, c.colorHex, c.id})) {
+            id = c.id;
+        }
+        return id >= 0;
+    });
+    return ok ? id : -1;
+}
+
+// DELETE ... WHERE id IN (?, ...) over ids, in chunks. Each chunk is padded
+// (by repeating its last id) to one of a few fixed arities, so the statement
+// cache holds at most three shapes per table no matter how many rows go.
+static bool deleteByIds(SqlRepo& repo, const char* table, const QList<int>& ids) {
+    static constexpr int kArities[] = {8, 64, 512};
+    for (qsizetype done = 0; done < ids.size();) {
+        const qsizetype left = ids.size() - done;
+        const int arity = left <= kArities[0] ? kArities[0] : left <= kArities[1] ? kArities[1] : kArities[2];
+        QVariantList args;
+        args.reserve(arity);
+        for (int i = 0; i < arity; ++i) args << ids[done + std::min<qsizetype>(i, std::min<qsizetype>(left, arity) - 1)];
+        QString marks = QStringLiteral("?");
+        marks += QStringLiteral(",?").repeated(arity - 1);
+        if (!repo.exec(QString("DELETE FROM %1 WHERE id IN (%2)").arg(QLatin1String(table), marks), args)) return false;
+        done += std::min<qsizetype>(left, arity);
+    }
+    return true;
+}
+
+// Their assignments go with them through ON DELETE CASCADE; one transaction for the batch.
+static bool deleteCourseRows(SqlRepo& repo, const QList<int>& courseIds) {
+    return writeTransaction(repo, [&] { return deleteByIds(repo, "courses", courseIds); });
+}
+
+static bool skipOccurrence(SqlRepo& repo, int occurrence) {
+    return bool(repo.exec("INSERT OR IGNORE INTO series_exceptions(series_id, occurrence) VALUES(?,?)",
+                          {occurrenceSeries(occurrence), occurrenceIndex(occurrence)}));
+}
+
+// Inserts when a.id < 0, otherwise updates; returns the row id or -1. A
+// series occurrence id inserts too, and skips that occurrence from then on.
+static int saveAssignmentRow(SqlRepo& repo, const Assignment& a) {
+    const qint64 due = a.dueAtUtc.toSecsSinceEpoch();
+    const QVariant start = a.startAtUtc ? QVariant(a.startAtUtc->toSecsSinceEpoch()) : QVariant();  // NULL
+    const QVariant duration = a.durationMin > 0 ? QVariant(a.durationMin) : QVariant();
+    const QVariant effort = a.effortHours > 0 ? QVariant(a.effortHours) : QVariant();
+    int id = -1;
+    const bool ok = writeTransaction(repo, [&] {
+        id = -1;
+        if (isOccurrenceId(a.id) && !skipOccurrence(repo, a.id)) return false;
+        if (a.id < 0) {
+            if (auto ins = repo.exec(R"(INSERT INTO assignments(course_id, type, title, due_at_utc, topics, notes, start_at_utc, duration_min, effort_hours)
+                                        VALUES(?,?,?,?,?,?,?,?,?))",
+                                     {a.courseId, toString(a.type), a.title, due, nullableText(a.topics), nullableText(a.notes), start, duration, effort}))
+                id = ins->lastInsertId().toInt();
+        } else if (repo.exec(R"(UPDATE assignments SET type=?, title=?, due_at_utc=?, topics=?, notes=?, start_at_utc=?, duration_min=?, effort_hours=?
+                                WHERE id=?)",
+                             {toString(a.type), a.title, due, nullableText(a.topics), nullableText(a.notes), start, duration, effort, a.id})) {
+            id = a.id;
+        }
+        return id >= 0;
+    });
+    return ok ? id : -1;
+}
+
+// AUTOINCREMENT never reuses an id, so once the next one would exceed
+// kMaxSeriesId no series can be added. Checked before inserting.
+static bool seriesIdsLeft(SqlRepo& repo) {
+    auto q = repo.exec(R"(SELECT MAX(COALESCE((SELECT seq FROM sqlite_sequence WHERE name='assignment_series'), 0),
+                                     COALESCE((SELECT MAX(id) FROM assignment_series), 0)))");
+    return q && q.next() && q->value(0).toLongLong() < kMaxSeriesId;
+}
+
+struct SeriesSaveResult { int id{-1}; QString error; };
+
+// Inserts a weekly series; id is -1 on failure.
+static SeriesSaveResult saveSeriesRow(SqlRepo& repo, const AssignmentSeries& s) {
+    int id = -1;
+    bool exhausted = false;
+    const bool ok = writeTransaction(repo, [&] {
+        id = -1;
+        exhausted = !seriesIdsLeft(repo);
+        if (exhausted) return false;
+        if (auto ins = repo.exec(R"(INSERT INTO assignment_series(course_id, type, title, topics, notes, first_due_utc, interval_weeks,
+                                                                   until_utc, max_count, duration_min, tzid, effort_hours)
+                                    VALUES(?,?,?,?,?,?,?,?,?,?,?,?))",
+                                 {s.courseId, toString(s.type), s.title, nullableText(s.topics), nullableText(s.notes), s.firstDueUtc,
+                                  s.intervalWeeks, s.untilUtc ? QVariant(*s.untilUtc) : QVariant(), s.count > 0 ? QVariant(s.count) : QVariant(),
+                                  s.durationMin, QString::fromUtf8(s.zone.id()), s.effortHours > 0 ? QVariant(s.effortHours) : QVariant()}))
+            id = ins->lastInsertId().toInt();
+        return id >= 0;
+    });
+    if (ok) return {id, {}};
+    if (exhausted) return {-1, QString("No more recurring series can be created: series ids are used up (limit %1).").arg(kMaxSeriesId)};
+    return {-1, "Could not save the series."};
+}
+
+// Occurrence ids are skipped rather than deleted. With wholeSeries their
+// series go instead; occurrences already edited into rows stay.
+static bool deleteAssignmentRows(SqlRepo& repo, const QList<int>& assignmentIds, bool wholeSeries = false) {
+    return writeTransaction(repo, [&] {
+        QList<int> rows, series;
+        for (int id : assignmentIds) {
+            if (!isOccurrenceId(id)) rows << id;
+            else if (wholeSeries) { if (!series.contains(occurrenceSeries(id))) series << occurrenceSeries(id); }
+            else if (!skipOccurrence(repo, id)) return false;
+        }
+        return deleteByIds(repo, "assignments", rows) && deleteByIds(repo, "assignment_series", series);
+    });
+}
+
+// Suppresses the change-capture triggers; set and cleared within one transaction.
+static bool setSyncApplying(SqlRepo& repo, bool on) {
+    return bool(repo.exec("UPDATE main.sync_state SET value=? WHERE key='applying'", {on ? 1 : 0}));
+}
+
+// Cold storage: finished semesters move to archivePath() with their ids and
+// the live table names, so fetchCourses/fetchAssignmentPage/fetchSeries read it
+// unchanged over a read-only connection (ConnectionPool::Source::Archive). The
+// file keeps the default rollback journal, which read-only opens need.
+static const std::vector<const char*>& archiveSchema() {
+    static const std::vector<const char*> sql = {
+        R"SQL(
+        CREATE TABLE IF NOT EXISTS archive.courses(
+          id INTEGER PRIMARY KEY,
+          user_id INTEGER NOT NULL,
+          semester_id INTEGER NOT NULL,
+          code TEXT NOT NULL,
+          name TEXT NOT NULL,
+          color_hex TEXT NOT NULL
+        );
+        )SQL",
+        "CREATE INDEX IF NOT EXISTS archive.idx_courses_user_sem_code ON courses(user_id, semester_id, code, name, color_hex)",
+        R"SQL(
+        CREATE TABLE IF NOT EXISTS archive.assignments(
+          id INTEGER PRIMARY KEY,
+          course_id INTEGER NOT NULL,
+          type TEXT NOT NULL,
+          title TEXT NOT NULL,
+          due_at_utc INTEGER NOT NULL,
+          topics TEXT NULL,
+          notes TEXT NULL,
+          start_at_utc INTEGER NULL,
+          duration_min INTEGER NULL
+        );
+        )SQL",
+        "CREATE INDEX IF NOT EXISTS archive.idx_assignments_course_due ON assignments(course_id, due_at_utc)",
+        R"SQL(
+        CREATE TABLE IF NOT EXISTS archive.assignment_series(
+          id INTEGER PRIMARY KEY,
+          course_id INTEGER NOT NULL,
+          type TEXT NOT NULL,
+          title TEXT NOT NULL,
+          topics TEXT NULL,
+          notes TEXT NULL,
+          first_due_utc INTEGER NOT NULL,
+          interval_weeks INTEGER NOT NULL DEFAULT 1,
+          until_utc INTEGER NULL,
+          max_count INTEGER NULL,
+          duration_min INTEGER NOT NULL DEFAULT 0,
+          tzid TEXT NOT NULL DEFAULT ''
+        );
+        )SQL",
+        "CREATE INDEX IF NOT EXISTS archive.idx_series_course ON assignment_series(course_id)",
+        R"SQL(
+        CREATE TABLE IF NOT EXISTS archive.series_exceptions(
+          series_id INTEGER NOT NULL,
+          occurrence INTEGER NOT NULL,
+          PRIMARY KEY(series_id, occurrence)
+        ) WITHOUT ROWID;
+        )SQL",
+    };
+    return sql;
+}
+
+// Columns the live tables gained later; entry i takes the archive's user_version from i to i + 1.
+static const std::vector<const char*>& archiveUpgrades() {
+    static const std::vector<const char*> sql = {
+        "ALTER TABLE archive.courses ADD COLUMN uid TEXT NULL",
+        "ALTER TABLE archive.assignments ADD COLUMN uid TEXT NULL",
+        "ALTER TABLE archive.assignment_series ADD COLUMN uid TEXT NULL",
+        "ALTER TABLE archive.assignments ADD COLUMN effort_hours REAL NULL",
+        "ALTER TABLE archive.assignment_series ADD COLUMN effort_hours REAL NULL",
+        "ALTER TABLE archive.assignments ADD COLUMN user_id INTEGER NULL",
+        "UPDATE archive.assignments SET user_id = (SELECT user_id FROM archive.courses c WHERE c.id = assignments.course_id)",
+        "CREATE INDEX IF NOT EXISTS archive.idx_assignments_user_due ON assignments(user_id, due_at_utc)",
+    };
+    return sql;
+}
+
+// Parents first; %1 in `rows` is the schema being read.
+struct ArchivedTable { const char* name; const char* columns; const char* rows; };
+static constexpr ArchivedTable kArchivedTables[] = {
+    {"courses", "id, user_id, semester_id, code, name, color_hex, uid", "semester_id = ?"},
+    {"assignments", "id, course_id, type, title, due_at_utc, topics, notes, start_at_utc, duration_min, uid, effort_hours, user_id",
+     "course_id IN (SELECT id FROM %1.courses WHERE semester_id = ?)"},
+    {"assignment_series", "id, course_id, type, title, topics, notes, first_due_utc, interval_weeks, until_utc, max_count, duration_min, tzid, uid, effort_hours",
+     "course_id IN (SELECT id FROM %1.courses WHERE semester_id = ?)"},
+    {"series_exceptions", "series_id, occurrence",
+     "series_id IN (SELECT s.id FROM %1.assignment_series s JOIN %1.courses c ON c.id = s.course_id WHERE c.semester_id = ?)"},
+};
+
+// A term is finished once nothing in it, series occurrences included, is due at or after nowUtc.
+static bool semesterFinished(SqlRepo& repo, int semesterId, qint64 nowUtc) {
+    if (auto q = repo.exec(R"(SELECT 1 FROM assignments a JOIN courses c ON c.id = a.course_id
+                              WHERE c.semester_id = ? AND a.due_at_utc >= ? LIMIT 1)", {semesterId, nowUtc}); !q || q.next())
+        return false;
+    std::vector<Assignment> next;
+    for (const auto& s : fetchSeries(repo, "c.semester_id = ? AND (s.until_utc IS NULL OR s.until_utc >= ?)", {semesterId, nowUtc}))
+        expandSeries(s, {nowUtc, std::numeric_limits<int>::min()}, 1, std::numeric_limits<qint64>::max(), next);
+    return next.empty();
+}
+
+static bool semesterArchived(SqlRepo& repo, int semesterId) {
+    auto q = repo.exec("SELECT archived FROM semesters WHERE id=?", {semesterId});
+    return q && q.next() && q->value(0).toBool();
+}
+
+struct ArchiveResult {
+    int courses = 0, assignments = 0;
+    qint64 bytesBefore = 0, bytesAfter = 0;  // live file, around the VACUUM
+    QString error;
+};
+
+// Creates or upgrades the tables of the database attached as `archive`.
+static bool upgradeAttachedArchive(SqlRepo& repo) {
+    bool ok = bool(repo.exec("PRAGMA archive.journal_mode=DELETE"));
+    for (const char* sql : archiveSchema()) if (!(ok = ok && bool(repo.exec(sql)))) break;
+    int archiveVersion = 0;
+    if (auto q = repo.exec("PRAGMA archive.user_version"); q && q.next()) archiveVersion = q->value(0).toInt();
+    const int latest = int(archiveUpgrades().size());
+    for (int v = archiveVersion; ok && v < latest; ++v) ok = bool(repo.exec(archiveUpgrades()[std::size_t(v)]));
+    if (ok && archiveVersion < latest) ok = bool(repo.exec(QString("PRAGMA archive.user_version=%1").arg(latest)));
+    return ok;
+}
+
+// Run after migrate(): the read-only archive connection cannot add columns
+// itself, so an archive written by an older build is upgraded up front.
+static bool upgradeArchive(SqlRepo& repo) {
+    if (!QFileInfo::exists(archivePath())) return true;
+    if (!repo.exec("ATTACH DATABASE ? AS archive", {archivePath()})) return false;
+    const bool ok = upgradeAttachedArchive(repo);
+    repo.invalidate();
+    repo.exec("DETACH DATABASE archive");
+    return ok;
+}
+
+// Moves every user's courses of a semester (with their assignments and series)
+// between the live database and the archive file, and flips semesters.archived.
+// SQLite gives no atomic commit across a WAL main file and an attached file,
+// so the move is two transactions: copy into the target and commit, then
+// delete from the source. A crash in between leaves the rows in both files
+// with the flag unchanged for an archive (the re-run replaces the archive
+// copy), or restored with a stale copy left in the archive (the next archive
+// of the term replaces it); rows are never in neither. Archiving ends with a
+// VACUUM so the live file gives the freed pages back.
+static ArchiveResult moveSemester(SqlRepo& repo, int semesterId, bool toArchive, bool compact) {
+    ArchiveResult res;
+    if (!repo.db().isOpen()) { res.error = "Cannot open database connection."; return res; }
+    // ATTACH, DETACH and VACUUM all refuse to run inside a transaction.
+    if (!repo.exec("ATTACH DATABASE ? AS archive", {archivePath()})) { res.error = repo.lastError().text(); return res; }
+    bool ok = upgradeAttachedArchive(repo);
+    const QString from = toArchive ? "main" : "archive", to = toArchive ? "archive" : "main";
+    const auto rowsOf = [](const ArchivedTable& t, const QString& schema) { return QString(QLatin1String(t.rows)).arg(schema); };
+    // Local housekeeping, not an edit: peers keep their copies (see pushSync)
+    const auto updateMain = [&](const std::function<bool()>& body) { return setSyncApplying(repo, true) && body() && setSyncApplying(repo, false); };
+    ok = ok && writeTransaction(repo, [&] {
+        res.courses = res.assignments = 0;
+        const auto copy = [&] {
+            for (const auto& t : kArchivedTables) {
+                // Ids never collide in main (AUTOINCREMENT); the archive may hold a copy from an interrupted run.
+                auto ins = repo.exec(QString("%1 INTO %2.%3(%4) SELECT %4 FROM %5.%3 WHERE %6")
+                                         .arg(QLatin1String(toArchive ? "INSERT OR REPLACE" : "INSERT"), to, QLatin1String(t.name),
+                                              QLatin1String(t.columns), from, rowsOf(t, from)), {semesterId});
+                if (!ins) return false;
+                if (t.name == std::string_view("courses")) res.courses = ins->numRowsAffected();
+                if (t.name == std::string_view("assignments")) res.assignments = ins->numRowsAffected();
+            }
+            if (toArchive) return true;
+            // Rows archived before uids existed get one on the way back
+            for (const char* t : {"courses", "assignments", "assignment_series"})
+                if (!repo.exec(QString("UPDATE main.%1 SET uid = lower(hex(randomblob(16))) WHERE uid IS NULL").arg(QLatin1String(t)))) return false;
+            return bool(repo.exec("UPDATE main.semesters SET archived=0 WHERE id=?", {semesterId}));
+        };
+        return toArchive ? copy() : updateMain(copy);
+    });
+    ok = ok && writeTransaction(repo, [&] {
+        const auto remove = [&] {
+            for (auto t = std::rbegin(kArchivedTables); t != std::rend(kArchivedTables); ++t)  // children first
+                if (!repo.exec(QString("DELETE FROM %1.%2 WHERE %3").arg(from, QLatin1String(t->name), rowsOf(*t, from)), {semesterId})) return false;
+            return !toArchive || bool(repo.exec("UPDATE main.semesters SET archived=1 WHERE id=?", {semesterId}));
+        };
+        return toArchive ? updateMain(remove) : remove();
+    });
+    if (!ok) res.error = repo.lastError().isValid() ? repo.lastError().text() : QString("Could not move the semester.");
+    repo.invalidate();  // cached statements on archive.* would keep DETACH from running
+    repo.exec("DETACH DATABASE archive");
+    if (!ok) return res;
+    res.bytesBefore = QFileInfo(databasePath()).size();
+    if (toArchive && compact) {
+        if (repo.exec("VACUUM") && StorageProfile::active().usesWal()) repo.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+        repo.invalidate();
+    }
+    res.bytesAfter = QFileInfo(databasePath()).size();
+    return res;
+}
+
+// compact=false leaves the VACUUM to the last of several archived terms.
+static ArchiveResult archiveSemester(SqlRepo& repo, int semesterId, bool compact = true) { return moveSemester(repo, semesterId, true, compact); }
+static ArchiveResult restoreSemester(SqlRepo& repo, int semesterId) { return moveSemester(repo, semesterId, false, false); }
+
+// Full-text search: every word of the input becomes a quoted prefix term, so
+// typing is forgiving and FTS5 query syntax in the input is never interpreted.
+static QString ftsQuery(const QString& text) {
+    static const QRegularExpression separators(QStringLiteral("[^\\p{L}\\p{N}_]+"));
+    QStringList terms;
+    for (const auto& word : text.split(separators, Qt::SkipEmptyParts))
+        terms << QChar('"') + word + QStringLiteral("\"*");
+    return terms.join(QChar(' '));
+}
+
+struct SearchHit {
+    int id{-1}, courseId{-1};
+    AssignType type{AssignType::Other};
+    QString title;
+    QDateTime dueAtUtc;
+    QString snippet;
+};
+
+static constexpr int kSearchLimit = 50;
+
+// Ranked hits within one user's semester; title matches weigh most, then topics, then notes.
+// A matching series is one hit, standing for its next occurrence (or its
+// first, once it has ended), so opening it edits that date.
+static std::vector<SearchHit> searchAssignments(SqlRepo& repo, int userId, int semesterId, const QString& text, int limit = kSearchLimit) {
+    std::vector<SearchHit> out;
+    const QString match = ftsQuery(text);
+    if (match.isEmpty()) return out;
+    std::vector<std::size_t> seriesHits;
+    if (auto q = repo.exec(R"(SELECT 0, a.id, a.course_id, a.type, a.title, a.due_at_utc,
+                                     snippet(assignments_fts, -1, '«', '»', '…', 10), bm25(assignments_fts, 10.0, 4.0, 1.0) AS rank
+                              FROM assignments_fts
+                              JOIN assignments a ON a.id = assignments_fts.rowid
+                              WHERE assignments_fts MATCH ? AND a.user_id = ?
+                                AND a.course_id IN (SELECT id FROM courses WHERE user_id = ? AND semester_id = ?)
+                              UNION ALL
+                              SELECT 1, s.id, s.course_id, s.type, s.title, s.first_due_utc,
+                                     snippet(series_fts, -1, '«', '»', '…', 10), bm25(series_fts, 10.0, 4.0, 1.0)
+                              FROM series_fts
+                              JOIN assignment_series s ON s.id = series_fts.rowid
+                              JOIN courses c ON c.id = s.course_id
+                              WHERE series_fts MATCH ? AND c.user_id = ? AND c.semester_id = ?
+                              ORDER BY rank
+                              LIMIT ?)", {match, userId, userId, semesterId, match, userId, semesterId, limit})) {
+        while (q.next()) {
+            if (q->value(0).toInt()) seriesHits.push_back(out.size());
+            out.push_back(SearchHit{q->value(1).toInt(), q->value(2).toInt(), parseAssignType(q->value(3).toString()),
+                                    q->value(4).toString(), QDateTime::fromSecsSinceEpoch(q->value(5).toLongLong()).toUTC(),
+                                    q->value(6).toString()});
+        }
+    }
+    const qint64 nowUtc = QDateTime::currentSecsSinceEpoch();
+    for (std::size_t i : seriesHits) {
+        SearchHit& h = out[i];
+        const auto series = fetchSeries(repo, "s.id = ?", {h.id});
+        std::vector<Assignment> next;
+        if (!series.empty()) {
+            expandSeries(series.front(), {nowUtc, std::numeric_limits<int>::min()}, 1, std::numeric_limits<qint64>::max(), next);
+            if (next.empty())
+                expandSeries(series.front(), {std::numeric_limits<qint64>::min(), std::numeric_limits<int>::min()}, 1,
+                             std::numeric_limits<qint64>::max(), next);
+        }
+        if (next.empty()) { h.id = -1; continue; }  // every date skipped
+        h.id = next.front().id;
+        h.dueAtUtc = next.front().dueAtUtc;
+    }
+    std::erase_if(out, [](const SearchHit& h) { return h.id == -1; });
+    return out;
+}
+
+// Queues f onto the GUI thread; it is skipped if guard's object has gone away.
+template <class F>
+static void deliverToGui(const QPointer<QObject>& guard, F f) {
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, f = std::move(f)]() mutable {
+        if (guard) f();
+    }, Qt::QueuedConnection);
+}
+
+// DbWorker: a dedicated thread owning its own named connection. Jobs run in
+// FIFO order on that thread against its SqlRepo; each result is handed back
+// on the GUI thread, and dropped if the receiver has been destroyed meanwhile.
+class DbWorker {
+public:
+    explicit DbWorker(const QString& connection = QStringLiteral("coursepilot_worker")) {
+        thread_.setObjectName(QStringLiteral("coursepilot-db"));
+        ctx_ = new QObject;
+        ctx_->moveToThread(&thread_);
+        QObject::connect(&thread_, &QThread::finished, ctx_, &QObject::deleteLater);
+        thread_.start();
+        run([this, connection] {
+            repo_ = std::make_unique<SqlRepo>(connection);
+            if (!repo_->open()) qWarning() << "DB worker: could not open" << connection;
+        });
+    }
+    DbWorker(const DbWorker&) = delete;
+    DbWorker& operator=(const DbWorker&) = delete;
+    // Lets queued jobs finish, then closes the connection on its own thread.
+    // The close is posted blocking: events run in order, so once it returns
+    // every earlier write has run, and quit() can no longer drop any of them.
+    ~DbWorker() {
+        QMetaObject::invokeMethod(ctx_, [this] {
+            if (!repo_) return;
+            repo_->exec("PRAGMA optimize");
+            repo_->close(); repo_.reset();
+        }, Qt::BlockingQueuedConnection);
+        thread_.quit();
+        thread_.wait();
+        if (shared_ == this) shared_ = nullptr;
+    }
+
+    static DbWorker& shared() { Q_ASSERT(shared_); return *shared_; }
+    static void setShared(DbWorker* w) { shared_ = w; }
+
+    // job(SqlRepo&) runs on the worker; done(result) runs on the GUI thread.
+    template <class Job, class Done>
+    void post(QObject* receiver, Job job, Done done) {
+        QPointer<QObject> guard(receiver);
+        run([this, guard, job = std::move(job), done = std::move(done)]() mutable {
+            auto result = job(*repo_);
+            deliverToGui(guard, [done = std::move(done), result = std::move(result)]() mutable { done(std::move(result)); });
+        });
+    }
+
+    // Periodic WAL checkpoint and planner statistics refresh, driven by timers
+    // on the worker's own event loop so they never wake the GUI thread.
+    void startMaintenance(const StorageProfile& p) {
+        run([this, walSec = p.usesWal() ? p.checkpointIntervalSec : 0, optSec = p.optimizeIntervalSec] {
+            const auto every = [this](int sec, const char* sql) {
+                if (sec <= 0) return;
+                auto* t = new QTimer(ctx_);
+                QObject::connect(t, &QTimer::timeout, ctx_, [this, sql] { if (repo_) repo_->exec(sql); });
+                t->start(std::chrono::seconds(sec));
+            };
+            every(walSec, "PRAGMA wal_checkpoint(PASSIVE)");
+            every(optSec, "PRAGMA optimize");
+        });
+    }
+
+    // Fire-and-forget job with no result.
+    template <class Job>
+    void post(Job job) { run([this, job = std::move(job)]() mutable { job(*repo_); }); }
+
+private:
+    template <class F>
+    void run(F f) { QMetaObject::invokeMethod(ctx_, std::move(f), Qt::QueuedConnection); }
+
+    QThread thread_;
+    QObject* ctx_{};
+    std::unique_ptr<SqlRepo> repo_;  // touched only on thread_
+    static inline DbWorker* shared_ = nullptr;
+};
+
+static QString nextPoolConnectionName() {
+    static std::atomic_int seq{0};
+    return QString("coursepilot_pool_%1").arg(++seq);
+}
+
+// Runs job(SqlRepo&) on a QThreadPool thread with a short-lived connection of
+// its own, for long jobs (import/export, sync, archive moves, password
+// hashing) that must not hold up the DB worker queue. Several of them write;
+// see ConnectionPool. The job should check repo.db().isOpen(); done(result)
+// runs on the GUI thread.
+template <class Job, class Done>
+static void runOnPoolConnection(QObject* receiver, Job job, Done done) {
+    QPointer<QObject> guard(receiver);
+    QThreadPool::globalInstance()->start([guard, job, done, connection = nextPoolConnectionName()]() mutable {
+        SqlRepo repo(connection);
+        repo.open();
+        auto result = job(repo);
+        repo.close();
+        deliverToGui(guard, [done, result]() mutable { done(std::move(result)); });
+    });
+}
+
+// ConnectionPool: a dedicated QThreadPool for short reads whose threads never
+// expire. Each thread opens one named connection on first use and keeps it,
+// statement cache included, until the pool is destroyed. Reads fan out here.
+// Interactive edits write on the single DbWorker, but DbWorker is not the
+// only writer in this process. Registration and the password rehash in
+// loginUser, importAssignments, moveSemester (archive/restore) and
+// pushSync/pullSync each write on their own runOnPoolConnection connection,
+// so two writers can contend. That is safe because each write transaction
+// opens with BEGIN IMMEDIATE (writeTransaction, or the import's own), taking
+// the write lock up front. busy_timeout, plus writeTransaction's backoff,
+// absorbs the wait. No write ever upgrades a read transaction, so no deadlock
+// can arise. Debug > Database Contention counts the busy retries.
+// Archived semesters are read through a second, read-only connection per thread.
+class ConnectionPool {
+public:
+    enum class Source { Live, Archive };
+
+    explicit ConnectionPool(int maxThreads = std::clamp(QThread::idealThreadCount(), 2, 4)) {
+        pool_.setObjectName(QStringLiteral("coursepilot-read-pool"));
+        pool_.setMaxThreadCount(maxThreads);
+        pool_.setExpiryTimeout(-1);
+    }
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+    // Joins the threads; each closes its connection as it exits.
+    ~ConnectionPool() {
+        pool_.waitForDone();
+        if (shared_ == this) shared_ = nullptr;
+    }
+
+    static ConnectionPool& shared() { Q_ASSERT(shared_); return *shared_; }
+    static void setShared(ConnectionPool* p) { shared_ = p; }
+
+    // job(SqlRepo&) runs on some pool thread; done(result) runs on the GUI thread.
+    template <class Job, class Done>
+    void post(QObject* receiver, Job job, Done done, Source source = Source::Live) {
+        QPointer<QObject> guard(receiver);
+        pool_.start([guard, job, done, source]() mutable {
+            auto result = job(threadRepo(source));
+            deliverToGui(guard, [done, result]() mutable { done(std::move(result)); });
+        });
+    }
+
+    static int openConnections() { return opened_.load(std::memory_order_relaxed); }
+
+private:
+    static SqlRepo& threadRepo(Source source) {
+        struct Connection {
+            SqlRepo repo{nextPoolConnectionName()};
+            explicit Connection(Source s) { if (s == Source::Archive ? repo.openArchive() : repo.open()) opened_.fetch_add(1, std::memory_order_relaxed); }
+            ~Connection() { if (repo.db().isOpen()) opened_.fetch_sub(1, std::memory_order_relaxed); repo.close(); }
+        };
+        // The archive file exists before any semester is marked archived, so opening it lazily here never races its creation.
+        if (source == Source::Archive) { thread_local Connection archive{Source::Archive}; return archive.repo; }
+        thread_local Connection live{Source::Live};
+        return live.repo;
+    }
+
+    QThreadPool pool_;
+    static inline std::atomic_int opened_{0};
+    static inline ConnectionPool* shared_ = nullptr;
+};
+
+// Bulk import: CSV and iCalendar readers stream one row at a time from a
+// QIODevice, and importAssignments writes them in a single transaction through
+// one cached INSERT. Unmappable rows are skipped and reported, not fatal.
+struct ImportRow {
+    Assignment assignment;
+    QString courseCode;  // empty -> the caller's default course
+};
+
+static AssignType importType(const QString& raw) {
+    const QString s = raw.trimmed();
+    const AssignType t = parseAssignType(s);
+    if (t != AssignType::Other) return t;
+    for (auto c : {AssignType::HW, AssignType::Quiz, AssignType::Midterm, AssignType::Final, AssignType::Project, AssignType::Essay})
+        if (s.compare(toString(c), Qt::CaseInsensitive) == 0) return c;
+    return AssignType::Other;
+}
+
+// ISO 8601 (offset optional, local time otherwise), a few common spreadsheet
+// layouts, or a bare date meaning 23:59 local that day.
+static std::optional<QDateTime> parseImportDateTime(const QString& raw) {
+    const QString s = raw.trimmed();
+    if (s.isEmpty()) return std::nullopt;
+    QDateTime dt = QDateTime::fromString(s, Qt::ISODate);
+    for (const char* fmt : {"yyyy-MM-dd HH:mm", "yyyy-MM-dd HH:mm:ss", "yyyy/MM/dd HH:mm", "MM/dd/yyyy HH:mm"}) {
+        if (dt.isValid()) break;
+        dt = QDateTime::fromString(s, QString::fromLatin1(fmt));
+    }
+    if (!dt.isValid()) {
+        const QDate d = QDate::fromString(s, Qt::ISODate);
+        if (d.isValid()) dt = QDateTime(d, QTime(23, 59));
+    }
+    if (!dt.isValid()) return std::nullopt;
+    return dt.toUTC();
+}
+
+class ImportReader {
+public:
+    explicit ImportReader(QIODevice& dev) : dev_(dev), in_(&dev) {}
+    virtual ~ImportReader() = default;
+    // Fills out with the next mappable row; false at end of input.
+    virtual bool next(ImportRow& out) = 0;
+
+    int skipped() const { return skipped_; }
+    const QStringList& problems() const { return problems_; }
+    // Fraction of the input consumed, in 1/1000
+    int progressPermille() const {
+        const qint64 size = dev_.size();
+        return size > 0 ? int(std::min<qint64>(1000, dev_.pos() * 1000 / size)) : 0;
+    }
+
+protected:
+    void skip(qint64 line, const QString& why) {
+        ++skipped_;
+        if (problems_.size() < 20) problems_ << QString("line %1: %2").arg(line).arg(why);
+    }
+
+    QIODevice& dev_;
+    QTextStream in_;
+    qint64 line_{0};
+
+private:
+    int skipped_{0};
+    QStringList problems_;
+};
+
+// CSV with a header row. Recognised columns (any order, case-insensitive):
+// type, title, due, topics, notes, course. Quoted fields may span lines.
+class CsvImportReader : public ImportReader {
+public:
+    explicit CsvImportReader(QIODevice& dev) : ImportReader(dev) {
+        QStringList header;
+        if (!readRecord(header)) return;
+        const auto col = [&](std::initializer_list<const char*> names) {
+            for (qsizetype i = 0; i < header.size(); ++i)
+                for (const char* n : names) if (header[i].trimmed().compare(QLatin1String(n), Qt::CaseInsensitive) == 0) return int(i);
+            return -1;
+        };
+        type_ = col({"type", "kind"});
+        title_ = col({"title", "summary", "name"});
+        due_ = col({"due", "due_at", "due date", "deadline"});
+        topics_ = col({"topics", "tags"});
+        notes_ = col({"notes", "description"});
+        course_ = col({"course", "course_code", "code"});
+        if (title_ < 0 || due_ < 0) skip(line_, "header needs at least 'title' and 'due' columns");
+    }
+
+    bool next(ImportRow& out) override {
+        if (title_ < 0 || due_ < 0) return false;
+        QStringList rec;
+        while (readRecord(rec)) {
+            if (rec.size() == 1 && rec[0].trimmed().isEmpty()) continue;
+            const auto field = [&](int c) { return c >= 0 && c < rec.size() ? rec[c].trimmed() : QString(); };
+            const auto due = parseImportDateTime(field(due_));
+            if (field(title_).isEmpty()) { skip(line_, "missing title"); continue; }
+            if (!due) { skip(line_, "unreadable due date '" + field(due_) + "'"); continue; }
+            out = ImportRow{};
+            auto& a = out.assignment;
+            a.type = importType(field(type_));
+            a.title = field(title_);
+            a.dueAtUtc = *due;
+            if (!field(topics_).isEmpty()) a.topics = field(topics_);
+            if (!field(notes_).isEmpty()) a.notes = field(notes_);
+            out.courseCode = field(course_);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    bool readRecord(QStringList& fields) {
+        fields.clear();
+        QString field, line;
+        bool quoted = false, any = false;
+        while (in_.readLineInto(&line)) {
+            ++line_; any = true;
+            for (qsizetype i = 0; i < line.size(); ++i) {
+                const QChar ch = line[i];
+                if (quoted) {
+                    if (ch != u'"') field += ch;
+                    else if (i + 1 < line.size() && line[i + 1] == u'"') { field += ch; ++i; }
+                    else quoted = false;
+                }
+                else if (ch == u'"') quoted = true;
+                else if (ch == u',') { fields << field; field.clear(); }
+                else field += ch;
+            }
+            if (!quoted) break;
+            field += u'\n';
+        }
+        if (!any) return false;
+        fields << field;
+        return true;
+    }
+
+    int type_{-1}, title_{-1}, due_{-1}, topics_{-1}, notes_{-1}, course_{-1};
+};
+
+// iCalendar VEVENT/VTODO: due from DUE, else DTSTART, else DTEND. CATEGORIES
+// naming an AssignType sets the type (the rest become topics);
+// X-COURSEPILOT-TYPE / X-COURSEPILOT-COURSE take precedence when present.
+class IcsImportReader : public ImportReader {
+public:
+    using ImportReader::ImportReader;
+
+    bool next(ImportRow& out) override {
+        QString line;
+        while (readUnfolded(line)) {
+            const auto [name, params, value] = splitProperty(line);
+            if (name == "BEGIN") {
+                if (depth_ > 0) ++depth_;
+                else if (value.compare("VEVENT", Qt::CaseInsensitive) == 0 || value.compare("VTODO", Qt::CaseInsensitive) == 0) {
+                    depth_ = 1; props_.clear(); categories_.clear(); startLine_ = line_;
+                }
+            } else if (name == "END" && depth_ > 0) {
+                if (--depth_ == 0 && build(out)) return true;
+            } else if (depth_ == 1) {
+                if (name == "CATEGORIES") categories_ << value.split(u',', Qt::SkipEmptyParts);
+                else if (!props_.contains(name)) props_.insert(name, {params, value});
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Prop { QString params, value; };
+    struct Parts { QString name, params, value; };
+
+    // Physical lines starting with a space or tab continue the previous one.
+    bool readUnfolded(QString& out) {
+        if (pending_.isNull()) { if (!in_.readLineInto(&pending_)) return false; ++line_; }
+        out = std::exchange(pending_, QString());
+        QString next;
+        while (in_.readLineInto(&next)) {
+            ++line_;
+            if (!next.isEmpty() && (next[0] == u' ' || next[0] == u'\t')) out += QStringView(next).mid(1);
+            else { pending_ = next; break; }
+        }
+        return true;
+    }
+
+    static Parts splitProperty(const QString& line) {
+        bool quoted = false;
+        for (qsizetype i = 0; i < line.size(); ++i) {
+            if (line[i] == u'"') quoted = !quoted;
+            else if (line[i] == u':' && !quoted) {
+                const QString head = line.left(i);
+                const qsizetype semi = head.indexOf(u';');
+                return {(semi < 0 ? head : head.left(semi)).toUpper(), semi < 0 ? QString() : head.mid(semi + 1), line.mid(i + 1)};
+            }
+        }
+        return {line.toUpper(), {}, {}};
+    }
+
+    static QString unescape(const QString& v) {
+        QString out; out.reserve(v.size());
+        for (qsizetype i = 0; i < v.size(); ++i) {
+            if (v[i] != u'\\' || i + 1 == v.size()) { out += v[i]; continue; }
+            const QChar n = v[++i];
+            out += (n == u'n' || n == u'N') ? QChar(u'\n') : n;
+        }
+        return out;
+    }
+
+    static std::optional<QDateTime> parseIcsDateTime(const Prop& p) {
+        QString tzid;
+        for (const auto& kv : p.params.split(u';'))
+            if (kv.startsWith("TZID=", Qt::CaseInsensitive)) tzid = kv.mid(5).remove(u'"');
+        const QString v = p.value.trimmed();
+        if (v.size() == 8) {
+            const QDate d = QDate::fromString(v, "yyyyMMdd");
+            if (!d.isValid()) return std::nullopt;
+            return QDateTime(d, QTime(23, 59)).toUTC();
+        }
+        const bool utc = v.endsWith(u'Z');
+        QDateTime dt = QDateTime::fromString(utc ? v.chopped(1) : v, "yyyyMMdd'T'HHmmss");
+        if (!dt.isValid()) return std::nullopt;
+        if (utc) dt.setTimeZone(QTimeZone::utc());
+        else if (!tzid.isEmpty()) { const QTimeZone tz(tzid.toUtf8()); if (tz.isValid()) dt.setTimeZone(tz); }
+        return dt.toUTC();
+    }
+
+    bool build(ImportRow& out) {
+        const Prop* due = nullptr;
+        for (const char* key : {"DUE", "DTSTART", "DTEND"}) if (props_.contains(key)) { due = &props_[key]; break; }
+        const QString title = unescape(props_.value("SUMMARY").value).trimmed();
+        if (title.isEmpty()) { skip(startLine_, "item without SUMMARY"); return false; }
+        const auto dueAt = due ? parseIcsDateTime(*due) : std::nullopt;
+        if (!dueAt) { skip(startLine_, "item without a readable DUE/DTSTART"); return false; }
+
+        out = ImportRow{};
+        auto& a = out.assignment;
+        a.title = title;
+        a.dueAtUtc = *dueAt;
+        QStringList topics;
+        for (const auto& c : std::as_const(categories_)) {
+            const QString cat = unescape(c).trimmed();
+            if (a.type == AssignType::Other && importType(cat) != AssignType::Other) a.type = importType(cat);
+            else if (!cat.isEmpty()) topics << cat;
+        }
+        if (props_.contains("X-COURSEPILOT-TYPE")) a.type = importType(props_["X-COURSEPILOT-TYPE"].value);
+        if (!topics.isEmpty()) a.topics = topics.join(", ");
+        const QString notes = unescape(props_.value("DESCRIPTION").value).trimmed();
+        if (!notes.isEmpty()) a.notes = notes;
+        out.courseCode = unescape(props_.value("X-COURSEPILOT-COURSE").value).trimmed();
+        return true;
     }
+
+    QString pending_;
+    int depth_{0};
+    qint64 startLine_{0};
+    QHash<QString, Prop> props_;
+    QStringList categories_;
+};
+
+static std::unique_ptr<ImportReader> makeImportReader(const QString& path, QIODevice& dev) {
+    const QString ext = QFileInfo(path).suffix().toLower();
+    if (ext == "ics" || ext == "ical" || ext == "ifb") return std::make_unique<IcsImportReader>(dev);
+    return std::make_unique<CsvImportReader>(dev);
 }
 
-static AssignType parseAssignType(const QString& s) {
-    if (s == "HW") return AssignType::HW;
-    if (s == "Quiz") return AssignType::Quiz;
-    if (s == "Midterm") return AssignType::Midterm;
-    if (s == "Final") return AssignType::Final;
-    if (s == "Project") return AssignType::Project;
-    if (s == "Essay") return AssignType::Essay;
-    return AssignType::Other;
+struct ImportOptions {
+    int userId{-1}, semesterId{-1};
+    int defaultCourseId{-1};  // used for rows without a course code
+};
+
+struct ImportResult {
+    int inserted{0}, skipped{0}, coursesCreated{0};
+    bool cancelled{false};
+    QString error;
+    QStringList problems;
+};
+
+// Unknown course codes become new courses in the target semester. Everything
+// lands in one transaction: a cancel or failure leaves the DB untouched.
+static ImportResult importAssignments(SqlRepo& repo, ImportReader& reader, const ImportOptions& opt,
+                                      const std::atomic_bool& cancel, const std::function<void(int permille)>& progress) {
+    ImportResult res;
+    QHash<QString, int> courseByCode;  // case-folded code -> id
+    if (auto q = repo.exec("SELECT id, code FROM courses WHERE user_id=? AND semester_id=?", {opt.userId, opt.semesterId}))
+        while (q.next()) courseByCode.insert(q->value(1).toString().toCaseFolded(), q->value(0).toInt());
+
+    // Not retried as a whole (the reader is consumed), but the write lock is taken up front.
+    if (!repo.exec("BEGIN IMMEDIATE")) { res.error = repo.lastError().text(); return res; }
+    const auto fail = [&](const QString& why) { repo.exec("ROLLBACK"); res.error = why; res.inserted = res.coursesCreated = 0; return res; };
+
+    ImportRow row;
+    int lastPermille = -1;
+    while (reader.next(row)) {
+        if (cancel.load(std::memory_order_relaxed)) { repo.exec("ROLLBACK"); res.cancelled = true; res.inserted = res.coursesCreated = 0; return res; }
+        int courseId = opt.defaultCourseId;
+        if (!row.courseCode.isEmpty()) {
+            const QString key = row.courseCode.toCaseFolded();
+            auto it = courseByCode.constFind(key);
+            if (it != courseByCode.cend()) courseId = *it;
+            else if (auto ins = repo.exec("INSERT INTO courses(user_id, semester_id, code, name, color_hex) VALUES(?,?,?,?,?)",
+                                          {opt.userId, opt.semesterId, row.courseCode, row.courseCode, QStringLiteral("#4F46E5")})) {
+                courseId = ins->lastInsertId().toInt();
+                courseByCode.insert(key, courseId);
+                ++res.coursesCreated;
+            }
+            else return fail("Could not create course " + row.courseCode);
+        }
+        if (courseId < 0) { ++res.skipped; if (res.problems.size() < 20) res.problems << "'" + row.assignment.title + "': no course"; continue; }
+
+        const auto& a = row.assignment;
+        if (!repo.exec(R"(INSERT INTO assignments(course_id, type, title, due_at_utc, topics, notes) VALUES(?,?,?,?,?,?))",
+                       {courseId, toString(a.type), a.title, a.dueAtUtc.toSecsSinceEpoch(), nullableText(a.topics), nullableText(a.notes)}))
+            return fail("Insert failed: " + repo.lastError().text());
+        ++res.inserted;
+
+        const int permille = reader.progressPermille();
+        if (progress && permille != lastPermille) { lastPermille = permille; progress(permille); }
+    }
+    if (!repo.exec("COMMIT")) return fail("Commit failed: " + repo.lastError().text());
+    res.skipped += reader.skipped();
+    res.problems = reader.problems() + res.problems;
+    return res;
 }
 
-struct Semester { int id{}; QString term; int year{}; };
+// Runs an import off the DB worker queue; progress and result arrive on the GUI thread.
+static void startImport(QObject* receiver, const QString& path, const ImportOptions& opt,
+                        std::shared_ptr<std::atomic_bool> cancel,
+                        std::function<void(int permille)> onProgress, std::function<void(ImportResult)> onDone) {
+    QPointer<QObject> guard(receiver);
+    runOnPoolConnection(receiver, [=](SqlRepo& repo) {
+        ImportResult res;
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) { res.error = "Cannot open " + path + ": " + f.errorString(); return res; }
+        if (!repo.db().isOpen()) { res.error = "Cannot open database connection."; return res; }
+        auto reader = makeImportReader(path, f);
+        return importAssignments(repo, *reader, opt, *cancel, [&](int permille) {
+            deliverToGui(guard, [onProgress, permille] { onProgress(permille); });
+        });
+    }, onDone);
+}
 
-struct Course {
-    int id{}, userId{}, semesterId{};
-    QString code, name, colorHex;
+// Streaming export: an outer forward-only cursor walks courses in index order
+// and an inner one walks each course's assignments by (course_id, due_at_utc),
+// so SQLite never sorts and rows go straight into a buffered QTextStream.
+// Series are expanded one course at a time and merged in by due date as
+// plain rows, so whatever is exported imports back complete. Memory stays
+// flat whether one semester or a whole lab database is exported.
+enum class ExportFormat { Csv, Ics, JsonLines };
+
+static ExportFormat exportFormatForPath(const QString& path) {
+    const QString ext = QFileInfo(path).suffix().toLower();
+    if (ext == "ics" || ext == "ical") return ExportFormat::Ics;
+    if (ext == "jsonl" || ext == "ndjson" || ext == "json") return ExportFormat::JsonLines;
+    return ExportFormat::Csv;
+}
+
+struct ExportScope {
+    int userId{-1};      // -1: every user
+    int semesterId{-1};  // -1: every semester
 };
 
-struct Assignment {
-    int id{}, courseId{};
-    AssignType type{AssignType::Other};
-    QString title;
-    QDateTime dueAtUtc;
-    std::optional<QString> topics, notes;
+struct ExportResult {
+    qint64 rows{0};
+    bool cancelled{false};
+    QString error;
 };
 
-// Min-heap comparator for "Upcoming" deadlines (soonest first)
-struct DueSooner {
-    bool operator()(const Assignment& a, const Assignment& b) const {
-        return a.dueAtUtc > b.dueAtUtc;
+class ExportWriter {
+public:
+    struct CourseCtx { QString username, term, code, name; int year{}; };
+
+    ExportWriter(QTextStream& out, ExportFormat fmt) : out_(out), fmt_(fmt) {}
+
+    void begin() {
+        if (fmt_ == ExportFormat::Csv) out_ << "user,term,year,course,type,title,due,topics,notes\n";
+        if (fmt_ == ExportFormat::Ics) {
+            stamp_ = QDateTime::currentDateTimeUtc().toString("yyyyMMdd'T'HHmmss'Z'");
+            out_ << "BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//CoursePilot//Export//EN\r\nCALSCALE:GREGORIAN\r\n";
+        }
+    }
+    void end() { if (fmt_ == ExportFormat::Ics) out_ << "END:VCALENDAR\r\n"; out_.flush(); }
+
+    void row(const CourseCtx& c, int id, const QString& type, const QString& title, qint64 dueUtc,
+             const QString& topics, const QString& notes) {
+        const QDateTime due = QDateTime::fromSecsSinceEpoch(dueUtc, QTimeZone::utc());
+        switch (fmt_) {
+        case ExportFormat::Csv:
+            out_ << csv(c.username) << ',' << csv(c.term) << ',' << c.year << ',' << csv(c.code) << ','
+                 << csv(type) << ',' << csv(title) << ',' << due.toString(Qt::ISODate) << ','
+                 << csv(topics) << ',' << csv(notes) << '\n';
+            break;
+        case ExportFormat::Ics: {
+            const QString when = due.toString("yyyyMMdd'T'HHmmss'Z'");
+            ics("BEGIN", "VEVENT");
+            ics("UID", isOccurrenceId(id) ? QString("series-%1-%2@coursepilot").arg(occurrenceSeries(id)).arg(occurrenceIndex(id))
+                                          : QString("assignment-%1@coursepilot").arg(id));
+            ics("DTSTAMP", stamp_);
+            ics("DTSTART", when);
+            ics("DTEND", when);
+            ics("SUMMARY", icsText(QString("[%1] %2 — %3").arg(type, c.code, title)));
+            ics("CATEGORIES", icsText(type));
+            if (!notes.isEmpty()) ics("DESCRIPTION", icsText(notes));
+            ics("X-COURSEPILOT-TYPE", icsText(type));
+            ics("X-COURSEPILOT-COURSE", icsText(c.code));
+            if (!topics.isEmpty()) ics("X-COURSEPILOT-TOPICS", icsText(topics));
+            ics("END", "VEVENT");
+            break;
+        }
+        case ExportFormat::JsonLines: {
+            QJsonObject o{{"id", id}, {"user", c.username}, {"term", c.term}, {"year", c.year},
+                          {"course", c.code}, {"course_name", c.name}, {"type", type}, {"title", title},
+                          {"due_utc", dueUtc}, {"due", due.toString(Qt::ISODate)}};
+            if (isOccurrenceId(id)) {
+                o.remove("id");
+                o.insert("series", occurrenceSeries(id)); o.insert("occurrence", occurrenceIndex(id));
+            }
+            if (!topics.isEmpty()) o.insert("topics", topics);
+            if (!notes.isEmpty()) o.insert("notes", notes);
+            out_ << QJsonDocument(o).toJson(QJsonDocument::Compact) << '\n';
+            break;
+        }
+        }
+    }
+
+private:
+    static QString csv(const QString& v) {
+        if (!v.contains(u',') && !v.contains(u'"') && !v.contains(u'\n') && !v.contains(u'\r')) return v;
+        return QStringLiteral("\"") + QString(v).replace(u'"', QStringLiteral("\"\"")) + QStringLiteral("\"");
+    }
+    static QString icsText(QString v) {
+        return v.replace(u'\\', QStringLiteral("\\\\")).replace(u';', QStringLiteral("\\;"))
+                .replace(u',', QStringLiteral("\\,")).replace(u'\n', QStringLiteral("\\n")).remove(u'\r');
+    }
+    // Content lines are folded at 75 octets (RFC 5545 3.1).
+    void ics(const char* name, const QString& value) {
+        const QString line = QString::fromLatin1(name) + QChar(u':') + value;
+        int octets = 0;
+        for (qsizetype i = 0; i < line.size(); ++i) {
+            const QChar ch = line[i];
+            const int n = ch.unicode() < 0x80 ? 1 : ch.unicode() < 0x800 ? 2 : ch.isSurrogate() ? 2 : 3;
+            if (octets + n > 75) { out_ << "\r\n "; octets = 1; }
+            out_ << ch; octets += n;
+        }
+        out_ << "\r\n";
     }
+
+    QTextStream& out_;
+    ExportFormat fmt_;
+    QString stamp_;
 };
 
-// SQLite DB setup and migrations
-static QString appDataPath() {
-    auto p = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir().mkpath(p);
-    return p;
+static ExportResult exportAssignments(SqlRepo& repo, QIODevice& dev, ExportFormat fmt, const ExportScope& scope,
+                                      const std::atomic_bool* cancel = nullptr) {
+    ExportResult res;
+    QTextStream out(&dev);
+    out.setEncoding(QStringConverter::Utf8);
+    ExportWriter w(out, fmt);
+    w.begin();
+
+    // Equality only on the columns in scope keeps each shape an index-ordered walk.
+    QString where = "1=1";
+    QVariantList args;
+    if (scope.userId >= 0) { where += " AND c.user_id = ?"; args << scope.userId; }
+    if (scope.semesterId >= 0) { where += " AND c.semester_id = ?"; args << scope.semesterId; }
+    auto courses = repo.exec(QString(R"(SELECT c.id, c.code, c.name, s.term, s.year, u.username
+                                        FROM courses c
+                                        JOIN semesters s ON s.id = c.semester_id
+                                        JOIN users u ON u.id = c.user_id
+                                        WHERE %1
+                                        ORDER BY c.user_id, c.semester_id, c.code)").arg(where), args);
+    if (!courses) { res.error = "Could not read courses: " + repo.db().lastError().text(); return res; }
+    while (courses.next()) {
+        const ExportWriter::CourseCtx ctx{courses->value(5).toString(), courses->value(3).toString(),
+                                          courses->value(1).toString(), courses->value(2).toString(), courses->value(4).toInt()};
+        std::vector<Assignment> occurrences;
+        for (const auto& s : fetchSeries(repo, "s.course_id = ?", {courses->value(0)}))
+            expandSeries(s, {std::numeric_limits<qint64>::min(), std::numeric_limits<int>::min()}, kMaxOccurrences,
+                         std::numeric_limits<qint64>::max(), occurrences);
+        std::sort(occurrences.begin(), occurrences.end(), [](const Assignment& x, const Assignment& y) { return DueSooner{}(y, x); });
+        auto next = occurrences.begin();
+        // Returns false once cancelled.
+        const auto put = [&](int id, const QString& type, const QString& title, qint64 due, const QString& topics, const QString& notes) {
+            w.row(ctx, id, type, title, due, topics, notes);
+            return (++res.rows & 1023) != 0 || !cancel || !cancel->load(std::memory_order_relaxed);
+        };
+        const auto putOccurrencesBefore = [&](qint64 due) {
+            for (; next != occurrences.end() && next->dueAtUtc.toSecsSinceEpoch() < due; ++next)
+                if (!put(next->id, toString(next->type), next->title, next->dueAtUtc.toSecsSinceEpoch(),
+                         next->topics.value_or(QString()), next->notes.value_or(QString()))) return false;
+            return true;
+        };
+        auto a = repo.exec(R"(SELECT id, type, title, due_at_utc, topics, notes
+                              FROM assignments WHERE course_id = ? ORDER BY due_at_utc)", {courses->value(0)});
+        if (!a) { res.error = "Could not read assignments: " + repo.db().lastError().text(); return res; }
+        while (a.next()) {
+            if (!putOccurrencesBefore(a->value(3).toLongLong())
+                || !put(a->value(0).toInt(), a->value(1).toString(), a->value(2).toString(), a->value(3).toLongLong(),
+                        a->value(4).toString(), a->value(5).toString())) { res.cancelled = true; return res; }
+        }
+        if (!putOccurrencesBefore(std::numeric_limits<qint64>::max())) { res.cancelled = true; return res; }
+    }
+    w.end();
+    if (out.status() != QTextStream::Ok) res.error = "Write error.";
+    return res;
 }
 
-static bool ensureDbOpen(QSqlDatabase& db) {
-    if (db.isOpen()) return true;
-    db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName(appDataPath() + "/coursepilot.db");
-    return db.open();
+// Writes to path through QSaveFile so a cancelled or failed export never
+// leaves a truncated file behind.
+static ExportResult exportToFile(SqlRepo& repo, const QString& path, ExportFormat fmt, const ExportScope& scope,
+                                 const std::atomic_bool* cancel = nullptr) {
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) return ExportResult{0, false, "Cannot write " + path + ": " + f.errorString()};
+    auto res = exportAssignments(repo, f, fmt, scope, cancel);
+    if (res.error.isEmpty() && !res.cancelled && !f.commit()) res.error = "Cannot write " + path + ": " + f.errorString();
+    return res;
 }
 
-static bool runMigrations(QSqlDatabase& db) {
-    QSqlQuery q(db);
-    if (!q.exec(R"SQL(
-        CREATE TABLE IF NOT EXISTS users(
-          id INTEGER PRIMARY KEY AUTOINCREMENT,
-          username TEXT UNIQUE NOT NULL,
-          password_hash BLOB NOT NULL,
-          created_at INTEGER NOT NULL
-        );
-    )SQL")) return false;
+// Sync: offline-first replication through a shared directory (a network
+// mount, or a folder the departmental server mirrors). The triggers of
+// migration 9 log every local change by uid; pushSync packs the rows changed
+// since the last push into one qCompress'd JSON batch, so a batch grows with
+// the number of changes and not with the database. pullSync applies other
+// devices' batches in sequence, last writer wins per row (sync_clock). Users
+// match by username, semesters by term and year; records for users this
+// database does not know, or for terms archived here, are skipped.
+struct SyncResult {
+    int sent = 0, received = 0, skipped = 0, batches = 0;
+    QString error;
+};
 
-    if (!q.exec(R"SQL(
-        CREATE TABLE IF NOT EXISTS semesters(
-          id INTEGER PRIMARY KEY AUTOINCREMENT,
-          term TEXT NOT NULL CHECK(term IN ('Fall','Spring')),
-          year INTEGER NOT NULL
-        );
-    )SQL")) return false;
+static constexpr int kSyncFormat = 1;
 
-    if (!q.exec(R"SQL(
-        CREATE TABLE IF NOT EXISTS courses(
-          id INTEGER PRIMARY KEY AUTOINCREMENT,
-          user_id INTEGER NOT NULL,
-          semester_id INTEGER NOT NULL,
-          code TEXT NOT NULL,
-          name TEXT NOT NULL,
-          color_hex TEXT NOT NULL,
-          FOREIGN KEY(user_id) REFERENCES users(id),
-          FOREIGN KEY(semester_id) REFERENCES semesters(id)
-        );
-    )SQL")) return false;
+static QVariant syncState(SqlRepo& repo, const QString& key) {
+    auto q = repo.exec("SELECT value FROM sync_state WHERE key=?", {key});
+    return q && q.next() ? q->value(0) : QVariant();
+}
 
-    if (!q.exec(R"SQL(
-        CREATE TABLE IF NOT EXISTS assignments(
-          id INTEGER PRIMARY KEY AUTOINCREMENT,
-          course_id INTEGER NOT NULL,
-          type TEXT NOT NULL,
-          title TEXT NOT NULL,
-          due_at_utc INTEGER NOT NULL,
-          topics TEXT NULL,
-          notes TEXT NULL,
-          FOREIGN KEY(course_id) REFERENCES courses(id)
-        );
-    )SQL")) return false;
+static bool setSyncState(SqlRepo& repo, const QString& key, const QVariant& value) {
+    return bool(repo.exec("INSERT OR REPLACE INTO sync_state(key, value) VALUES(?,?)", {key, value}));
+}
 
-    return true;
+// <device>-<last change_log seq, zero-padded>.cpsync: name order is batch order per device.
+static QString syncBatchName(const QString& device, qint64 seq) {
+    return QString("%1-%2.cpsync").arg(device).arg(seq, 12, 10, QChar('0'));
+}
+
+// Apply order: parents before children for upserts, the reverse for deletes.
+static int syncRank(const QString& table) {
+    static const QStringList order{"semesters", "courses", "assignment_series", "assignments", "series_exceptions"};
+    return int(order.indexOf(table));
+}
+
+// Bind values for the row a uid names: semesters use 'Term Year', exceptions '<series uid>:<occurrence>'.
+static QVariantList syncKey(const QString& table, const QString& uid) {
+    const QChar sep = table == "semesters" ? QChar(' ') : QChar(':');
+    const qsizetype at = uid.lastIndexOf(sep);
+    if (table == "semesters" || table == "series_exceptions") return {uid.left(at), uid.mid(at + 1).toLongLong()};
+    return {uid};
+}
+
+static QJsonValue syncJson(const QVariant& v) { return v.isNull() ? QJsonValue() : QJsonValue::fromVariant(v); }
+static QVariant syncValue(const QJsonValue& v) { return v.isNull() || v.isUndefined() ? QVariant() : v.toVariant(); }
+
+// Current state of one row as a batch record; nullopt when it no longer exists.
+static std::optional<QJsonObject> syncPayload(SqlRepo& repo, const QString& table, const QString& uid) {
+    struct Shape { const char* sql; std::vector<const char*> fields; };
+    static const QHash<QString, Shape> shapes{
+        {"semesters", {"SELECT term, year FROM semesters WHERE term=? AND year=?", {"term", "year"}}},
+        {"courses", {R"(SELECT u.username, s.term, s.year, c.code, c.name, c.color_hex FROM courses c
+                        JOIN users u ON u.id = c.user_id JOIN semesters s ON s.id = c.semester_id WHERE c.uid=?)",
+                     {"user", "term", "year", "code", "name", "color"}}},
+        {"assignment_series", {R"(SELECT c.uid, s.type, s.title, s.topics, s.notes, s.first_due_utc, s.interval_weeks, s.until_utc,
+                                         s.max_count, s.duration_min, s.tzid, s.effort_hours
+                                  FROM assignment_series s JOIN courses c ON c.id = s.course_id WHERE s.uid=?)",
+                               {"course", "type", "title", "topics", "notes", "first_due", "interval", "until", "max_count", "duration", "tzid",
+                                "effort"}}},
+        {"assignments", {R"(SELECT c.uid, a.type, a.title, a.due_at_utc, a.topics, a.notes, a.start_at_utc, a.duration_min, a.effort_hours
+                            FROM assignments a JOIN courses c ON c.id = a.course_id WHERE a.uid=?)",
+                         {"course", "type", "title", "due", "topics", "notes", "start", "duration", "effort"}}},
+        {"series_exceptions", {R"(SELECT s.uid, e.occurrence FROM series_exceptions e JOIN assignment_series s ON s.id = e.series_id
+                                  WHERE s.uid=? AND e.occurrence=?)", {"series", "occurrence"}}},
+    };
+    const auto shape = shapes.constFind(table);
+    if (shape == shapes.cend()) return std::nullopt;
+    auto q = repo.exec(QLatin1String(shape->sql), syncKey(table, uid));
+    if (!q || !q.next()) return std::nullopt;
+    QJsonObject o;
+    for (std::size_t i = 0; i < shape->fields.size(); ++i) o.insert(QLatin1String(shape->fields[i]), syncJson(q->value(int(i))));
+    return o;
+}
+
+// Writes one batch with the latest state of every row logged since the last
+// push, then trims the log. A crash before the trim only resends the batch.
+static SyncResult pushSync(SqlRepo& repo, const QString& dir) {
+    SyncResult res;
+    const QString device = syncState(repo, "device").toString();
+    struct Change { QString table, uid, op; };
+    std::vector<Change> changes;
+    QHash<QString, std::size_t> latest;  // table + '\t' + uid -> index in changes
+    qint64 lastSeq = 0;
+    if (auto q = repo.exec("SELECT seq, tbl, uid, op FROM change_log ORDER BY seq")) while (q.next()) {
+        lastSeq = q->value(0).toLongLong();
+        Change c{q->value(1).toString(), q->value(2).toString(), q->value(3).toString()};
+        const QString key = c.table + '\t' + c.uid;
+        if (auto it = latest.constFind(key); it != latest.cend()) changes[*it] = std::move(c);
+        else { latest.insert(key, changes.size()); changes.push_back(std::move(c)); }
+    }
+    if (changes.empty()) return res;
+
+    QJsonArray records;
+    for (const auto& c : changes) {
+        QJsonObject r;
+        if (c.op == "upsert") {
+            auto payload = syncPayload(repo, c.table, c.uid);
+            if (!payload) continue;  // gone since; its delete is logged or was never shared
+            r = *payload;
+        }
+        r.insert("t", c.table); r.insert("uid", c.uid); r.insert("op", c.op);
+        if (auto q = repo.exec("SELECT changed_at, device FROM sync_clock WHERE tbl=? AND uid=?", {c.table, c.uid}); q && q.next()) {
+            r.insert("at", q->value(0).toLongLong()); r.insert("by", q->value(1).toString());
+        }
+        records.append(r);
+    }
+    const QJsonObject batch{{"format", kSyncFormat}, {"device", device}, {"seq", lastSeq}, {"records", records}};
+    QSaveFile f(QDir(dir).filePath(syncBatchName(device, lastSeq)));
+    if (!f.open(QIODevice::WriteOnly) || f.write(qCompress(QJsonDocument(batch).toJson(QJsonDocument::Compact), 9)) < 0 || !f.commit()) {
+        res.error = "Cannot write " + f.fileName() + ": " + f.errorString();
+        return res;
+    }
+    if (!writeTransaction(repo, [&] { return bool(repo.exec("DELETE FROM change_log WHERE seq <= ?", {lastSeq})); })) {
+        res.error = repo.lastError().text();
+        return res;
+    }
+    res.sent = int(records.size());
+    res.batches = 1;
+    return res;
+}
+
+static std::optional<int> syncLookupId(SqlRepo& repo, const char* sql, const QVariantList& args) {
+    auto q = repo.exec(QLatin1String(sql), args);
+    if (q && q.next()) return q->value(0).toInt();
+    return std::nullopt;
+}
+
+// Applies one record; false only on a database error. Records older than the
+// local state, or whose parent row is unknown here, are counted as skipped.
+static bool applySyncRecord(SqlRepo& repo, const QJsonObject& r, SyncResult& res) {
+    const QString table = r["t"].toString(), uid = r["uid"].toString(), by = r["by"].toString();
+    const qint64 at = r["at"].toInteger();
+    const bool remove = r["op"].toString() == "delete";
+    const auto skip = [&] { ++res.skipped; return true; };
+    if (syncRank(table) < 0 || uid.isEmpty()) return skip();
+    if (auto q = repo.exec("SELECT changed_at, device FROM sync_clock WHERE tbl=? AND uid=?", {table, uid}); q && q.next()) {
+        const qint64 localAt = q->value(0).toLongLong();
+        if (localAt > at || (localAt == at && q->value(1).toString() >= by)) return skip();
+    }
+    const auto text = [&](const char* field) { return syncValue(r[QLatin1String(field)]); };
+    // UPDATE by uid, or INSERT when the row is new here.
+    const auto upsert = [&](const char* update, const char* insert, QVariantList args) {
+        args << uid;
+        auto q = repo.exec(QLatin1String(update), args);
+        if (!q) return false;
+        return q->numRowsAffected() > 0 || bool(repo.exec(QLatin1String(insert), args));
+    };
+    bool ok = true;
+    if (table == "semesters") {
+        const QString term = text("term").toString();
+        if (remove || (term != "Fall" && term != "Spring")) return skip();
+        ok = bool(repo.exec("INSERT INTO semesters(term, year) SELECT ?, ? WHERE NOT EXISTS (SELECT 1 FROM semesters WHERE term=? AND year=?)",
+                            {term, text("year"), term, text("year")}));
+    } else if (table == "series_exceptions") {
+        const auto key = syncKey(table, uid);
+        const auto series = syncLookupId(repo, "SELECT id FROM assignment_series WHERE uid=?", {key[0]});
+        if (!series) return skip();
+        ok = bool(repo.exec(remove ? "DELETE FROM series_exceptions WHERE series_id=? AND occurrence=?"
+                                   : "INSERT OR IGNORE INTO series_exceptions(series_id, occurrence) VALUES(?,?)", {*series, key[1]}));
+    } else if (remove) {
+        ok = bool(repo.exec(QString("DELETE FROM %1 WHERE uid=?").arg(table), {uid}));  // table is whitelisted by syncRank
+    } else if (table == "courses") {
+        const auto user = syncLookupId(repo, "SELECT id FROM users WHERE username=?", {text("user")});
+        const auto semester = syncLookupId(repo, "SELECT id FROM semesters WHERE term=? AND year=? AND archived=0", {text("term"), text("year")});
+        if (!user || !semester) return skip();
+        ok = upsert("UPDATE courses SET user_id=?, semester_id=?, code=?, name=?, color_hex=? WHERE uid=?",
+                    "INSERT INTO courses(user_id, semester_id, code, name, color_hex, uid) VALUES(?,?,?,?,?,?)",
+                    {*user, *semester, text("code"), text("name"), text("color")});
+    } else {
+        const auto course = syncLookupId(repo, "SELECT id FROM courses WHERE uid=?", {text("course")});
+        if (!course) return skip();
+        if (table == "assignments")
+            ok = upsert(R"(UPDATE assignments SET course_id=?, type=?, title=?, due_at_utc=?, topics=?, notes=?, start_at_utc=?, duration_min=?,
+                                  effort_hours=? WHERE uid=?)",
+                        R"(INSERT INTO assignments(course_id, type, title, due_at_utc, topics, notes, start_at_utc, duration_min, effort_hours, uid)
+                           VALUES(?,?,?,?,?,?,?,?,?,?))",
+                        {*course, text("type"), text("title"), text("due"), text("topics"), text("notes"), text("start"), text("duration"),
+                         text("effort")});
+        else if (!syncLookupId(repo, "SELECT 1 FROM assignment_series WHERE uid=?", {uid}) && !seriesIdsLeft(repo)) {
+            qWarning() << "Skipping synced series" << uid << "- series ids are used up";
+            return skip();
+        } else
+            ok = upsert(R"(UPDATE assignment_series SET course_id=?, type=?, title=?, topics=?, notes=?, first_due_utc=?, interval_weeks=?,
+                                  until_utc=?, max_count=?, duration_min=?, tzid=?, effort_hours=? WHERE uid=?)",
+                        R"(INSERT INTO assignment_series(course_id, type, title, topics, notes, first_due_utc, interval_weeks, until_utc,
+                                                         max_count, duration_min, tzid, effort_hours, uid) VALUES(?,?,?,?,?,?,?,?,?,?,?,?,?))",
+                        {*course, text("type"), text("title"), text("topics"), text("notes"), text("first_due"), text("interval"),
+                         text("until"), text("max_count"), text("duration"), text("tzid"), text("effort")});
+    }
+    if (!ok) return false;
+    ++res.received;
+    return bool(repo.exec("INSERT OR REPLACE INTO sync_clock(tbl, uid, changed_at, device) VALUES(?,?,?,?)", {table, uid, at, by}));
+}
+
+// Applies every peer batch not seen yet, one transaction per batch.
+static SyncResult pullSync(SqlRepo& repo, const QString& dir) {
+    SyncResult res;
+    const QString self = syncState(repo, "device").toString();
+    static const QRegularExpression name(QStringLiteral("^([0-9a-f]+)-([0-9]{12})\\.cpsync$"));
+    for (const QString& file : QDir(dir).entryList({"*.cpsync"}, QDir::Files, QDir::Name)) {
+        const auto m = name.match(file);
+        if (!m.hasMatch() || m.captured(1) == self) continue;
+        const QString device = m.captured(1);
+        const qint64 seq = m.captured(2).toLongLong();
+        if (seq <= syncState(repo, "recv:" + device).toLongLong()) continue;
+        QFile f(QDir(dir).filePath(file));
+        if (!f.open(QIODevice::ReadOnly)) { res.error = "Cannot read " + f.fileName() + ": " + f.errorString(); return res; }
+        const QJsonObject batch = QJsonDocument::fromJson(qUncompress(f.readAll())).object();
+        if (batch["format"].toInt() != kSyncFormat || batch["device"].toString() != device) {
+            res.error = "Not a sync batch: " + f.fileName();
+            return res;
+        }
+        std::vector<QJsonObject> records;
+        for (const auto& v : batch["records"].toArray()) records.push_back(v.toObject());
+        const auto order = [](const QJsonObject& r) {
+            const int rank = syncRank(r["t"].toString());
+            return r["op"].toString() == "delete" ? 100 - rank : rank;
+        };
+        std::stable_sort(records.begin(), records.end(), [&](const QJsonObject& a, const QJsonObject& b) { return order(a) < order(b); });
+        SyncResult batchRes;
+        const bool ok = writeTransaction(repo, [&] {
+            batchRes = {};
+            if (!setSyncApplying(repo, true)) return false;
+            for (const auto& r : records) if (!applySyncRecord(repo, r, batchRes)) return false;
+            return setSyncState(repo, "recv:" + device, seq) && setSyncApplying(repo, false);
+        });
+        if (!ok) { res.error = "Applying " + file + " failed: " + repo.lastError().text(); return res; }
+        res.received += batchRes.received;
+        res.skipped += batchRes.skipped;
+        ++res.batches;
+    }
+    return res;
 }
 
-static QByteArray hashPassword(const QString& pw) {
-    return QCryptographicHash::hash(pw.toUtf8(), QCryptographicHash::Sha256);
+// One round: peers' changes in, then ours out.
+static SyncResult syncWithDirectory(SqlRepo& repo, const QString& dir) {
+    if (!repo.db().isOpen()) return SyncResult{0, 0, 0, 0, "Cannot open database connection."};
+    if (dir.isEmpty() || !QDir().mkpath(dir)) return SyncResult{0, 0, 0, 0, "Cannot use sync directory " + dir};
+    SyncResult res = pullSync(repo, dir);
+    if (!res.error.isEmpty()) return res;
+    const SyncResult out = pushSync(repo, dir);
+    res.sent = out.sent;
+    res.batches += out.batches;
+    res.error = out.error;
+    return res;
 }
 
 // AuthDialog: Register/Login
@@ -133,43 +3352,56 @@ public:
         form->addRow("Username", user_);
         form->addRow("Password", pass_);
 
-        auto btnLogin = new QPushButton("Login");
-        auto btnRegister = new QPushButton("Register");
-        auto row = new QHBoxLayout; row->addWidget(btnLogin); row->addWidget(btnRegister);
+        btnLogin_ = new QPushButton("Login");
+        btnRegister_ = new QPushButton("Register");
+        auto row = new QHBoxLayout; row->addWidget(btnLogin_); row->addWidget(btnRegister_);
+
+        busy_ = new QProgressBar;
+        busy_->setRange(0, 0);  // indeterminate while the KDF runs
+        busy_->setTextVisible(false);
+        busy_->setVisible(false);
 
-        auto v = new QVBoxLayout; v->addLayout(form); v->addLayout(row); setLayout(v);
+        auto v = new QVBoxLayout; v->addLayout(form); v->addWidget(busy_); v->addLayout(row); setLayout(v);
 
-        connect(btnLogin, &QPushButton::clicked, this, &AuthDialog::onLogin);
-        connect(btnRegister, &QPushButton::clicked, this, &AuthDialog::onRegister);
+        connect(btnLogin_, &QPushButton::clicked, this, &AuthDialog::onLogin);
+        connect(btnRegister_, &QPushButton::clicked, this, &AuthDialog::onRegister);
     }
     int userId() const { return userId_; }
+    QString username() const { return user_->text(); }
 
 private slots:
     void onLogin() {
-        QSqlQuery q;
-        q.prepare("SELECT id, password_hash FROM users WHERE username = ?");
-        q.addBindValue(user_->text());
-        if (!q.exec() || !q.next()) { QMessageBox::warning(this, "Login failed", "User not found."); return; }
-        const int id = q.value(0).toInt();
-        const auto stored = q.value(1).toByteArray();
-        if (stored != hashPassword(pass_->text())) {
-            QMessageBox::warning(this, "Login failed", "Incorrect password."); return;
-        }
-        userId_ = id; accept();
+        setBusy(true);
+        runOnPoolConnection(this, [user = user_->text(), pw = pass_->text(), iter = configuredKdfIterations()](SqlRepo& repo) {
+            return loginUser(repo, user, pw, iter);
+        }, [this](LoginResult res) {
+            setBusy(false);
+            if (!res.error.isEmpty()) { QMessageBox::warning(this, "Login failed", res.error); return; }
+            userId_ = res.userId; accept();
+        });
     }
     void onRegister() {
-        QSqlDatabase::database().transaction();
-        QSqlQuery q;
-        q.prepare("INSERT INTO users(username, password_hash, created_at) VALUES(?,?,?)");
-        q.addBindValue(user_->text());
-        q.addBindValue(hashPassword(pass_->text()));
-        q.addBindValue(QDateTime::currentSecsSinceEpoch());
-        if (!q.exec()) { QSqlDatabase::database().rollback(); QMessageBox::warning(this, "Register failed", "Username exists?"); return; }
-        QSqlDatabase::database().commit();
-        QMessageBox::information(this, "Registered", "User created. Please login.");
+        setBusy(true);
+        runOnPoolConnection(this, [user = user_->text(), pw = pass_->text(), iter = configuredKdfIterations()](SqlRepo& repo) {
+            return registerUser(repo, user, pw, iter);
+        }, [this](QString error) {
+            setBusy(false);
+            if (!error.isEmpty()) { QMessageBox::warning(this, "Register failed", error); return; }
+            QMessageBox::information(this, "Registered", "User created. Please login.");
+        });
     }
 private:
+    void setBusy(bool busy) {
+        busy_->setVisible(busy);
+        btnLogin_->setEnabled(!busy);
+        btnRegister_->setEnabled(!busy);
+        user_->setEnabled(!busy);
+        pass_->setEnabled(!busy);
+    }
+
     QLineEdit *user_{}, *pass_{};
+    QPushButton *btnLogin_{}, *btnRegister_{};
+    QProgressBar* busy_{};
     int userId_ = -1;
 };
 
@@ -178,193 +3410,824 @@ class SemesterPicker : public QDialog {
     Q_OBJECT
 public:
     int semesterId{-1};
+    void reject() override { if (!saving_) QDialog::reject(); }
     SemesterPicker(QWidget* parent=nullptr) : QDialog(parent) {
         setWindowTitle("Select Semester");
         term_ = new QComboBox; term_->addItems({"Fall","Spring"});
         year_ = new QSpinBox; year_->setRange(2022, 2042); year_->setValue(QDate::currentDate().year());
 
         auto form = new QFormLayout; form->addRow("Term", term_); form->addRow("Year", year_);
-        auto ok = new QPushButton("OK");
-        auto v = new QVBoxLayout; v->addLayout(form); v->addWidget(ok); setLayout(v);
+        btnOk_ = new QPushButton("OK");
+        auto v = new QVBoxLayout; v->addLayout(form); v->addWidget(btnOk_); setLayout(v);
 
-        connect(ok, &QPushButton::clicked, this, &SemesterPicker::onOk);
+        connect(btnOk_, &QPushButton::clicked, this, &SemesterPicker::onOk);
     }
 private slots:
     void onOk() {
-        QSqlQuery q; q.prepare("SELECT id FROM semesters WHERE term=? AND year=?");
-        q.addBindValue(term_->currentText()); q.addBindValue(year_->value());
-        if (q.exec() && q.next()) { semesterId = q.value(0).toInt(); }
-        else {
-            QSqlDatabase::database().transaction();
-            QSqlQuery ins; ins.prepare("INSERT INTO semesters(term, year) VALUES(?,?)");
-            ins.addBindValue(term_->currentText()); ins.addBindValue(year_->value());
-            if (ins.exec()) { semesterId = ins.lastInsertId().toInt(); QSqlDatabase::database().commit(); }
-            else { QSqlDatabase::database().rollback(); }
-        }
-        accept();
+        const QVariantList key{term_->currentText(), year_->value()};
+        setSaving(true);
+        DbWorker::shared().post(this, [key](SqlRepo& r) {
+            int id = -1;
+            writeTransaction(r, [&] {
+                id = -1;
+                auto q = r.exec("SELECT id FROM semesters WHERE term=? AND year=?", key);
+                if (q && q.next()) { id = q->value(0).toInt(); return true; }
+                auto ins = r.exec("INSERT INTO semesters(term, year) VALUES(?,?)", key);
+                if (ins) id = ins->lastInsertId().toInt();
+                return bool(ins);
+            });
+            return id;
+        }, [this](int id) {
+            setSaving(false);
+            if (id >= 0) { semesterId = id; accept(); }
+            else QMessageBox::warning(this, "Error", "Could not create the semester.");
+        });
+    }
+private:
+    void setSaving(bool on) {
+        saving_ = on;
+        term_->setEnabled(!on); year_->setEnabled(!on); btnOk_->setEnabled(!on);
+    }
+
+    bool saving_{false};
+    QComboBox* term_{};
+    QSpinBox* year_{};
+    QPushButton* btnOk_{};
+};
+
+// CourseDialog: Add/Edit course
+class CourseDialog : public QDialog {
+    Q_OBJECT
+public:
+    int courseId{-1};
+    // Row as written by the last successful save
+    Course saved() const {
+        return Course{courseId, userId_, semId_, code_->text(), name_->text(), colorOrDefault()};
+    }
+    // Closing mid-save would drop the result, so wait for the worker.
+    void reject() override { if (!saving_) QDialog::reject(); }
+    // Add optional courseId for editing
+    CourseDialog(int userId, int semId, QWidget* parent=nullptr, int editCourseId = -1)
+        : QDialog(parent), userId_(userId), semId_(semId), editCourseId_(editCourseId) {
+        setWindowTitle(editCourseId_ < 0 ? "Add Course" : "Edit Course");
+        code_ = new QLineEdit; code_->setPlaceholderText("Course code (e.g., CS101)");
+        name_ = new QLineEdit; name_->setPlaceholderText("Course name");
+        color_ = new QLineEdit; color_->setPlaceholderText("Color (optional, hex)");
+
+        fields_ = new QWidget;
+        auto form = new QFormLayout(fields_); form->setContentsMargins({});
+        form->addRow("Code", code_); form->addRow("Name", name_); form->addRow("Color", color_);
+
+        btnSave_ = new QPushButton("Save");
+        auto v = new QVBoxLayout; v->addWidget(fields_); v->addWidget(btnSave_); setLayout(v);
+
+        connect(btnSave_, &QPushButton::clicked, this, &CourseDialog::onSave);
+
+        // If editing, load course data on the read pool; the form waits for it
+        if (editCourseId_ >= 0) {
+            setLoading(true);
+            ConnectionPool::shared().post(this, [id = editCourseId_](SqlRepo& r) {
+                std::optional<QStringList> row;
+                if (auto q = r.exec("SELECT code, name, color_hex FROM courses WHERE id=?", {id}); q && q.next())
+                    row = QStringList{q->value(0).toString(), q->value(1).toString(), q->value(2).toString()};
+                return row;
+            }, [this](std::optional<QStringList> row) {
+                setLoading(false);
+                if (!row) { QMessageBox::warning(this, "Error", "Could not load the course."); return; }
+                code_->setText(row->at(0)); name_->setText(row->at(1)); color_->setText(row->at(2));
+            });
+        }
+    }
+private slots:
+    void onSave() {
+        Course c{editCourseId_ < 0 ? -1 : editCourseId_, userId_, semId_, code_->text(), name_->text(), colorOrDefault()};
+        setSaving(true);
+        DbWorker::shared().post(this, [c](SqlRepo& r) { return saveCourseRow(r, c); }, [this](int id) {
+            setSaving(false);
+            if (id >= 0) { courseId = id; accept(); }
+            else QMessageBox::warning(this, "Error", editCourseId_ < 0 ? "Could not save course." : "Could not update course.");
+        });
+    }
+private:
+    QString colorOrDefault() const { return color_->text().isEmpty() ? QStringLiteral("#4F46E5") : color_->text(); }
+    void setSaving(bool on) { saving_ = on; setLoading(on); }
+    // Unlike a save, a pending load does not hold the dialog open.
+    void setLoading(bool on) { fields_->setEnabled(!on); btnSave_->setEnabled(!on); }
+
+    int userId_, semId_, editCourseId_{-1};
+    bool saving_{false};
+    QWidget* fields_{};
+    QLineEdit *code_{}, *name_{}, *color_{};
+    QPushButton* btnSave_{};
+};
+
+// AssignmentDialog: Add/Edit assignment
+class AssignmentDialog : public QDialog {
+    Q_OBJECT
+public:
+    int assignmentId{-1};
+    int seriesId{-1};  // set instead of assignmentId when a weekly series was added
+    // Row as written by the last successful save
+    const Assignment& saved() const { return saved_; }
+    void reject() override { if (!saving_) QDialog::reject(); }
+    // Add optional assignmentId for editing; a series occurrence id edits that one occurrence
+    AssignmentDialog(int courseId, QWidget* parent=nullptr, int editAssignmentId = -1)
+        : QDialog(parent), courseId_(courseId), editAssignmentId_(editAssignmentId) {
+        setWindowTitle(adding() ? "Add Assignment" : isOccurrenceId(editAssignmentId_) ? "Edit Occurrence" : "Edit Assignment");
+        type_ = new QComboBox; type_->addItems({"HW","Quiz","Midterm","Final","Project","Essay","Other"});
+        title_ = new QLineEdit;
+        dueDate_ = new QDateTimeEdit(QDateTime::currentDateTime()); dueDate_->setCalendarPopup(true);
+        hasStart_ = new QCheckBox;
+        startDate_ = new QDateTimeEdit(QDateTime::currentDateTime()); startDate_->setCalendarPopup(true); startDate_->setEnabled(false);
+        auto startRow = new QHBoxLayout; startRow->addWidget(hasStart_); startRow->addWidget(startDate_, 1);
+        duration_ = new QSpinBox; duration_->setRange(0, 14 * 24 * 60); duration_->setSingleStep(15);
+        duration_->setSuffix(" min"); duration_->setSpecialValueText("None");
+        effort_ = new QDoubleSpinBox; effort_->setRange(0, 200); effort_->setDecimals(1); effort_->setSingleStep(0.5);
+        effort_->setSuffix(" h"); effort_->setSpecialValueText("Typical for type");
+        topics_ = new QLineEdit; topics_->setPlaceholderText("Optional: topics/tags");
+        notes_ = new QTextEdit;
+        connect(hasStart_, &QCheckBox::toggled, startDate_, &QWidget::setEnabled);
+
+        fields_ = new QWidget;
+        auto form = new QFormLayout(fields_); form->setContentsMargins({});
+        form->addRow("Type", type_); form->addRow("Title", title_);
+        form->addRow("Due at", dueDate_); form->addRow("Starts at", startRow); form->addRow("Duration", duration_);
+        form->addRow("Effort", effort_);
+        if (adding()) {
+            repeat_ = new QCheckBox("Every");
+            interval_ = new QSpinBox; interval_->setRange(1, 8); interval_->setSuffix(" week(s) until"); interval_->setEnabled(false);
+            until_ = new QDateEdit(QDate::currentDate().addDays(15 * 7)); until_->setCalendarPopup(true); until_->setEnabled(false);
+            auto repeatRow = new QHBoxLayout; repeatRow->addWidget(repeat_); repeatRow->addWidget(interval_); repeatRow->addWidget(until_, 1);
+            form->addRow("Repeat", repeatRow);
+            connect(repeat_, &QCheckBox::toggled, this, [this](bool on) {
+                interval_->setEnabled(on); until_->setEnabled(on);
+                hasStart_->setEnabled(!on); if (on) hasStart_->setChecked(false);  // series carry a duration, not a start
+            });
+        }
+        form->addRow("Topics", topics_); form->addRow("Notes", notes_);
+
+        btnSave_ = new QPushButton("Save");
+        auto v = new QVBoxLayout; v->addWidget(fields_); v->addWidget(btnSave_); setLayout(v);
+        connect(btnSave_, &QPushButton::clicked, this, &AssignmentDialog::onSave);
+
+        // If editing, load the row (or occurrence) on the read pool; the form waits for it
+        if (!adding()) {
+            if (isOccurrenceId(editAssignmentId_))
+                v->insertWidget(0, new QLabel("Saving detaches this date from its weekly series; the others stay as they are."));
+            setLoading(true);
+            ConnectionPool::shared().post(this, [id = editAssignmentId_](SqlRepo& r) { return fetchAssignment(r, id); },
+                                          [this](std::optional<Assignment> a) {
+                setLoading(false);
+                if (!a) { QMessageBox::warning(this, "Error", "Could not load the assignment."); return; }
+                type_->setCurrentText(toString(a->type));
+                title_->setText(a->title);
+                dueDate_->setDateTime(a->dueAtUtc.toLocalTime());
+                topics_->setText(a->topics.value_or(QString()));
+                notes_->setPlainText(a->notes.value_or(QString()));
+                hasStart_->setChecked(a->startAtUtc.has_value());
+                if (a->startAtUtc) startDate_->setDateTime(a->startAtUtc->toLocalTime());
+                duration_->setValue(a->durationMin);
+                effort_->setValue(a->effortHours);
+            });
+        }
+    }
+private slots:
+    void onSave() {
+        if (repeat_ && repeat_->isChecked()) { saveSeries(); return; }
+        Assignment a;
+        a.id = editAssignmentId_;
+        a.courseId = courseId_;
+        a.type = parseAssignType(type_->currentText());
+        a.title = title_->text();
+        a.dueAtUtc = dueDate_->dateTime().toUTC();
+        if (!topics_->text().isEmpty()) a.topics = topics_->text();
+        if (!notes_->toPlainText().isEmpty()) a.notes = notes_->toPlainText();
+        if (hasStart_->isChecked()) a.startAtUtc = startDate_->dateTime().toUTC();
+        a.durationMin = duration_->value();
+        a.effortHours = effort_->value();
+        if (a.startAtUtc && a.durationMin == 0 && *a.startAtUtc > a.dueAtUtc) {
+            QMessageBox::warning(this, "Invalid window", "The start must not be after the due time."); return;
+        }
+        setSaving(true);
+        saved_ = a;
+        DbWorker::shared().post(this, [a](SqlRepo& r) { return saveAssignmentRow(r, a); }, [this](int id) {
+            setSaving(false);
+            if (id >= 0) { assignmentId = saved_.id = id; accept(); }
+            else QMessageBox::warning(this, "Error", adding() ? "Could not save assignment." : "Could not update assignment.");
+        });
+    }
+private:
+    bool adding() const { return editAssignmentId_ == -1; }
+    void setSaving(bool on) { saving_ = on; setLoading(on); }
+    // Unlike a save, a pending load does not hold the dialog open.
+    void setLoading(bool on) { fields_->setEnabled(!on); btnSave_->setEnabled(!on); }
+
+    void saveSeries() {
+        AssignmentSeries s;
+        s.courseId = courseId_;
+        s.type = parseAssignType(type_->currentText());
+        s.title = title_->text();
+        if (!topics_->text().isEmpty()) s.topics = topics_->text();
+        if (!notes_->toPlainText().isEmpty()) s.notes = notes_->toPlainText();
+        s.firstDueUtc = dueDate_->dateTime().toSecsSinceEpoch();
+        s.intervalWeeks = interval_->value();
+        s.untilUtc = QDateTime(until_->date(), QTime(23, 59, 59)).toSecsSinceEpoch();
+        s.durationMin = duration_->value();
+        s.effortHours = effort_->value();
+        if (*s.untilUtc < s.firstDueUtc) { QMessageBox::warning(this, "Invalid series", "The series must not end before its first due date."); return; }
+        setSaving(true);
+        DbWorker::shared().post(this, [s](SqlRepo& r) { return saveSeriesRow(r, s); }, [this](const SeriesSaveResult& res) {
+            setSaving(false);
+            if (res.id >= 0) { seriesId = res.id; accept(); }
+            else QMessageBox::warning(this, "Error", res.error);
+        });
+    }
+
+    int courseId_, editAssignmentId_{-1};
+    bool saving_{false};
+    Assignment saved_;
+    QWidget* fields_{};
+    QPushButton* btnSave_{};
+    QComboBox* type_{};
+    QLineEdit *title_{}, *topics_{};
+    QDateTimeEdit *dueDate_{}, *startDate_{};
+    QCheckBox* hasStart_{};
+    QSpinBox* duration_{};
+    QDoubleSpinBox* effort_{};
+    QTextEdit* notes_{};
+    QCheckBox* repeat_{};  // repeat controls exist only when adding
+    QSpinBox* interval_{};
+    QDateEdit* until_{};
+};
+
+// View formatting shared by the lists and tables. The locale and its short
+// date-time pattern are looked up once, not per row (a QLocale change at run
+// time takes a restart to show).
+static const QLocale& uiLocale() { static const QLocale locale; return locale; }
+static QString shortDateTime(const QDateTime& t) {
+    static const QString pattern = uiLocale().dateTimeFormat(QLocale::ShortFormat);
+    return uiLocale().toString(t.toLocalTime(), pattern);
+}
+static const QString& recurringLabel(AssignType t) {
+    static const auto labels = [] {
+        std::array<QString, 7> out;
+        for (std::size_t i = 0; i < out.size(); ++i) out[i] = toString(AssignType(i)) + QStringLiteral(" ↻");
+        return out;
+    }();
+    return labels[std::min(std::size_t(t), labels.size() - 1)];
+}
+
+// Row `row` of a list, created on demand. Refreshes retext the items they
+// already have instead of clearing and reallocating them; trimList drops the
+// rows past the new end.
+static QListWidgetItem* listRow(QListWidget* list, int row) {
+    if (auto* it = list->item(row)) return it;
+    auto* it = new QListWidgetItem;
+    list->addItem(it);
+    return it;
+}
+static void trimList(QListWidget* list, int count) {
+    while (list->count() > count) delete list->takeItem(list->count() - 1);
+}
+
+// AssignmentTableModel: one course's assignments, paged in by keyset on
+// (due_at_utc, id) as the view scrolls; pages load on the DB worker. Rows stay
+// compact; display strings are only built in data() for painted cells.
+// Paging suits only the due-ascending, unfiltered view: the proxy above sorts
+// and filters just the rows loaded so far. So while a filter is set or another
+// order is shown, setDrain(true) fetches every remaining page in turn.
+class AssignmentTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column { ColType, ColTitle, ColDue, ColTopics, ColumnCount };
+    static constexpr int SortRole = Qt::UserRole + 1;
+    static constexpr int kFetchBatch = 256;
+    using Row = AssignmentStore::Row;
+
+    explicit AssignmentTableModel(ConnectionPool& db, QObject* parent=nullptr) : QAbstractTableModel(parent), db_(db) {}
+
+    void setCourse(int courseId, ConnectionPool::Source source = ConnectionPool::Source::Live) {
+        beginResetModel();
+        rows_.clear();
+        courseId_ = courseId;
+        source_ = source;
+        atEnd_ = courseId < 0;
+        fetching_ = false;
+        ++*generation_;  // pages still in flight belong to the previous course; queued ones never run
+        endResetModel();
+        if (canFetchMore({})) fetchMore({});
+    }
+    int courseId() const { return courseId_; }
+
+    // With drain on, each page that arrives requests the next until the end.
+    void setDrain(bool on) {
+        drain_ = on;
+        if (drain_ && canFetchMore({})) fetchMore({});
+    }
+
+    // Drops deleted rows in place, one removal per contiguous run, without refetching.
+    void removeIds(const QList<int>& ids) {
+        std::vector<Row> rows;
+        for (int id : ids) if (auto r = rows_.rowOf(id)) rows.push_back(*r);
+        std::sort(rows.begin(), rows.end());
+        for (auto end = rows.size(); end > 0;) {
+            auto begin = end - 1;
+            while (begin > 0 && rows[begin - 1] + 1 == rows[begin]) --begin;
+            const Row first = rows[begin], count = Row(end - begin);
+            beginRemoveRows({}, int(first), int(first + count - 1));
+            rows_.eraseRows(first, count);
+            endRemoveRows();
+            end = begin;
+        }
+    }
+    int idAt(int row) const { return row >= 0 && row < int(rows_.size()) ? rows_.id(Row(row)) : -1; }
+
+    int rowCount(const QModelIndex& parent = {}) const override { return parent.isValid() ? 0 : int(rows_.size()); }
+    int columnCount(const QModelIndex& parent = {}) const override { return parent.isValid() ? 0 : ColumnCount; }
+
+    QVariant data(const QModelIndex& idx, int role) const override {
+        if (!idx.isValid() || idx.row() >= int(rows_.size())) return {};
+        const Row r = Row(idx.row());
+        // QDateTime/QString are built here, for the cells the view asks for.
+        if (role == Qt::DisplayRole) switch (idx.column()) {
+            case ColType: return isOccurrenceId(rows_.id(r)) ? recurringLabel(rows_.type(r)) : toString(rows_.type(r));
+            case ColTitle: return rows_.title(r).toString();
+            case ColDue: return shortDateTime(QDateTime::fromSecsSinceEpoch(rows_.due(r)));
+            case ColTopics: return rows_.topics(r).toString();
+        }
+        if (role == SortRole) switch (idx.column()) {
+            case ColType: return int(rows_.type(r));
+            case ColDue: return rows_.due(r);
+            default: return data(idx, Qt::DisplayRole);
+        }
+        if (role == Qt::UserRole) return rows_.id(r);
+        if (role == Qt::ToolTipRole && isOccurrenceId(rows_.id(r))) return QString("Part of a weekly series");
+        return {};
+    }
+
+    QVariant headerData(int section, Qt::Orientation o, int role) const override {
+        if (o != Qt::Horizontal || role != Qt::DisplayRole) return QAbstractTableModel::headerData(section, o, role);
+        static const char* labels[ColumnCount] = {"Type", "Title", "Due (local)", "Topics"};
+        return section >= 0 && section < ColumnCount ? QString(labels[section]) : QVariant();
+    }
+
+    bool canFetchMore(const QModelIndex& parent) const override { return !parent.isValid() && !atEnd_ && !fetching_; }
+
+    void fetchMore(const QModelIndex& parent) override {
+        if (!canFetchMore(parent)) return;
+        fetching_ = true;
+        const Row last = Row(rows_.size() - 1);
+        const qint64 afterDue = rows_.empty() ? std::numeric_limits<qint64>::min() : rows_.due(last);
+        const int afterId = rows_.empty() ? std::numeric_limits<int>::min() : rows_.id(last);
+        const quint64 gen = generation_->load();
+        db_.post(this, [latest = generation_, gen, courseId = courseId_, afterDue, afterId](SqlRepo& r) {
+            if (latest->load() != gen) return AssignmentStore{};
+            return fetchAssignmentPage(r, courseId, afterDue, afterId, kFetchBatch);
+        }, [this, gen](AssignmentStore batch) {
+            if (gen != generation_->load()) return;
+            fetching_ = false;
+            atEnd_ = int(batch.size()) < kFetchBatch;
+            if (batch.empty()) return;
+            Metrics::Scope scope("ui.assignments");
+            const int first = int(rows_.size());
+            beginInsertRows({}, first, first + int(batch.size()) - 1);
+            rows_.append(batch);  // pages are disjoint keyset ranges, so rows stay in (due, id) order
+            endInsertRows();
+            if (drain_ && canFetchMore({})) fetchMore({});
+        }, source_);
+    }
+
+private:
+    ConnectionPool& db_;
+    int courseId_{-1};
+    ConnectionPool::Source source_{ConnectionPool::Source::Live};
+    bool atEnd_{true}, fetching_{false}, drain_{false};
+    std::shared_ptr<std::atomic<quint64>> generation_ = std::make_shared<std::atomic<quint64>>(0);  // shared with queued page jobs
+    AssignmentStore rows_;
+};
+
+// MainWindow: Dashboard
+// Debug > Diagnostics: the Metrics tables, JSON dump and query plans.
+class DiagnosticsDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit DiagnosticsDialog(QWidget* parent=nullptr) : QDialog(parent) {
+        setWindowTitle("Diagnostics");
+        resize(900, 560);
+        enabled_ = new QCheckBox("Collect query and view timings");
+        enabled_->setChecked(Metrics::enabled());
+        statements_ = new QTreeWidget;
+        statements_->setHeaderLabels({"Statement", "Count", "Mean µs", "p50 µs", "p95 µs", "Max µs", "Rows", "Changed", "Errors"});
+        statements_->setRootIsDecorated(false);
+        statements_->setSortingEnabled(true);
+        timings_ = new QTreeWidget;
+        timings_->setHeaderLabels({"Timing", "Count", "Mean µs", "p50 µs", "p95 µs", "Max µs"});
+        timings_->setRootIsDecorated(false);
+        plan_ = new QPlainTextEdit; plan_->setReadOnly(true); plan_->setPlaceholderText("Select a statement to see its query plan.");
+
+        auto split = new QSplitter(Qt::Vertical);
+        split->addWidget(statements_); split->addWidget(timings_); split->addWidget(plan_);
+        split->setStretchFactor(0, 3);
+        auto btnRefresh = new QPushButton("Refresh");
+        auto btnReset = new QPushButton("Reset");
+        auto btnCopy = new QPushButton("Copy JSON");
+        auto btnSave = new QPushButton("Save JSON…");
+        auto buttons = new QHBoxLayout;
+        buttons->addWidget(enabled_); buttons->addStretch();
+        for (auto* b : {btnRefresh, btnReset, btnCopy, btnSave}) buttons->addWidget(b);
+        auto v = new QVBoxLayout; v->addWidget(split); v->addLayout(buttons); setLayout(v);
+
+        connect(enabled_, &QCheckBox::toggled, this, [](bool on) { Metrics::setEnabled(on); });
+        connect(btnRefresh, &QPushButton::clicked, this, &DiagnosticsDialog::refresh);
+        connect(btnReset, &QPushButton::clicked, this, [this] { Metrics::instance().clear(); refresh(); });
+        connect(btnCopy, &QPushButton::clicked, this, [] { QGuiApplication::clipboard()->setText(json()); });
+        connect(btnSave, &QPushButton::clicked, this, &DiagnosticsDialog::saveJson);
+        connect(statements_, &QTreeWidget::currentItemChanged, this, [this](QTreeWidgetItem* it) { explain(it); });
+        refresh();
+    }
+
+private slots:
+    void refresh() {
+        const auto us = [](double ns) { return QString::number(ns / 1000.0, 'f', 1); };
+        const auto fill = [&](QTreeWidgetItem* it, const Metrics::Histogram& h) {
+            const quint64 n = h.count.load();
+            it->setText(1, QString::number(n));
+            it->setText(2, us(n ? double(h.totalNs.load()) / double(n) : 0.0));
+            it->setText(3, QString::number(h.quantileUs(0.5)));
+            it->setText(4, QString::number(h.quantileUs(0.95)));
+            it->setText(5, us(double(h.maxNs.load())));
+            for (int c = 1; c < it->columnCount(); ++c) it->setTextAlignment(c, Qt::AlignRight);
+        };
+        statements_->setSortingEnabled(false);
+        statements_->clear();
+        Metrics::instance().forEachStatement([&](const Metrics::Statement& st) {
+            if (!st.latency.count.load() && !st.errors.load()) return;
+            auto* it = new QTreeWidgetItem(statements_);
+            it->setText(0, st.sql.simplified());
+            it->setToolTip(0, st.sql);
+            fill(it, st.latency);
+            it->setText(6, QString::number(st.rows.load()));
+            it->setText(7, QString::number(st.changed.load()));
+            it->setText(8, QString::number(st.errors.load()));
+        });
+        statements_->setSortingEnabled(true);
+        statements_->sortByColumn(1, Qt::DescendingOrder);
+        timings_->clear();
+        Metrics::instance().forEachTiming([&](const QString& name, const Metrics::Histogram& h) {
+            auto* it = new QTreeWidgetItem(timings_);
+            it->setText(0, name);
+            fill(it, h);
+        });
+        statements_->resizeColumnToContents(1);
+    }
+
+    void saveJson() {
+        const QString path = QFileDialog::getSaveFileName(this, "Save Diagnostics", "coursepilot-metrics.json", "JSON (*.json)");
+        if (path.isEmpty()) return;
+        QSaveFile f(path);
+        const QByteArray data = json().toUtf8();
+        if (!f.open(QIODevice::WriteOnly) || f.write(data) != data.size() || !f.commit())
+            QMessageBox::warning(this, "Diagnostics", "Could not write " + path);
+    }
+
+private:
+    static QString json() {
+        QJsonObject o = Metrics::instance().toJson();
+        o.insert("contention", ContentionStats::instance().summary());
+        return QString::fromUtf8(QJsonDocument(o).toJson(QJsonDocument::Indented));
+    }
+
+    // Parameters are bound as NULL; the plan depends on indexes, not values.
+    void explain(QTreeWidgetItem* it) {
+        plan_->clear();
+        if (!it) return;
+        const QString sql = it->toolTip(0).trimmed();
+        if (!sql.startsWith("SELECT", Qt::CaseInsensitive) && !sql.startsWith("WITH", Qt::CaseInsensitive)
+            && !sql.startsWith("UPDATE", Qt::CaseInsensitive) && !sql.startsWith("DELETE", Qt::CaseInsensitive)) {
+            plan_->setPlainText("No query plan for this statement.");
+            return;
+        }
+        QSqlQuery q(SqlRepo::ui().db());
+        if (!q.prepare("EXPLAIN QUERY PLAN " + sql)) { plan_->setPlainText(q.lastError().text()); return; }
+        for (qsizetype i = 0, n = sql.count('?'); i < n; ++i) q.bindValue(int(i), QVariant());
+        if (!q.exec()) { plan_->setPlainText(q.lastError().text()); return; }
+        QStringList lines;
+        QHash<int, int> depth;  // plan row id -> nesting level
+        while (q.next()) {
+            const int d = depth.value(q.value(1).toInt(), -1) + 1;
+            depth.insert(q.value(0).toInt(), d);
+            lines << QString(d * 2, ' ') + q.value(3).toString();
+        }
+        plan_->setPlainText(lines.join('\n'));
     }
-private:
-    QComboBox* term_{};
-    QSpinBox* year_{};
+
+    QCheckBox* enabled_{};
+    QTreeWidget *statements_{}, *timings_{};
+    QPlainTextEdit* plan_{};
 };
 
-// CourseDialog: Add/Edit course
-class CourseDialog : public QDialog {
+// Left-column course list: one code-ordered snapshot, display text built on
+// demand. A semester switch is one model reset; saves and deletes touch
+// only their rows.
+class CourseListModel : public QAbstractListModel {
     Q_OBJECT
 public:
-    int courseId{-1};
-    // Add optional courseId for editing
-    CourseDialog(int userId, int semId, QWidget* parent=nullptr, int editCourseId = -1)
-        : QDialog(parent), userId_(userId), semId_(semId), editCourseId_(editCourseId) {
-        setWindowTitle(editCourseId_ < 0 ? "Add Course" : "Edit Course");
-        code_ = new QLineEdit; code_->setPlaceholderText("Course code (e.g., CS101)");
-        name_ = new QLineEdit; name_->setPlaceholderText("Course name");
-        color_ = new QLineEdit; color_->setPlaceholderText("Color (optional, hex)");
-
-        auto form = new QFormLayout;
-        form->addRow("Code", code_); form->addRow("Name", name_); form->addRow("Color", color_);
+    using QAbstractListModel::QAbstractListModel;
 
-        auto btnSave = new QPushButton("Save");
-        auto v = new QVBoxLayout; v->addLayout(form); v->addWidget(btnSave); setLayout(v);
+    int rowCount(const QModelIndex& parent = {}) const override { return parent.isValid() ? 0 : int(rows_.size()); }
+    QVariant data(const QModelIndex& idx, int role) const override {
+        if (!idx.isValid() || idx.row() >= int(rows_.size())) return {};
+        const Course& c = rows_[std::size_t(idx.row())];
+        if (role == Qt::DisplayRole) return QString("%1 — %2").arg(c.code, c.name);
+        if (role == Qt::UserRole) return c.id;
+        return {};
+    }
 
-        connect(btnSave, &QPushButton::clicked, this, &CourseDialog::onSave);
+    void setCourses(std::vector<Course> rows) {
+        beginResetModel();
+        rows_ = std::move(rows);
+        std::sort(rows_.begin(), rows_.end(), CourseDirectory::byCode);
+        endResetModel();
+    }
+    int idAt(int row) const { return row >= 0 && row < int(rows_.size()) ? rows_[std::size_t(row)].id : -1; }
+    int rowOf(int courseId) const {
+        for (std::size_t r = 0; r < rows_.size(); ++r) if (rows_[r].id == courseId) return int(r);
+        return -1;
+    }
 
-        // If editing, load course data
-        if (editCourseId_ >= 0) {
-            QSqlQuery q; q.prepare("SELECT code, name, color_hex FROM courses WHERE id=?");
-            q.addBindValue(editCourseId_);
-            if (q.exec() && q.next()) {
-                code_->setText(q.value(0).toString());
-                name_->setText(q.value(1).toString());
-                color_->setText(q.value(2).toString());
-            }
+    // Edits that keep the row's place are a dataChanged; otherwise it moves.
+    void upsert(const Course& c) {
+        if (const int r = rowOf(c.id); r >= 0) {
+            rows_[std::size_t(r)] = c;
+            const auto i = std::size_t(r);
+            const bool inPlace = (i == 0 || !CourseDirectory::byCode(c, rows_[i - 1])) &&
+                                 (i + 1 == rows_.size() || !CourseDirectory::byCode(rows_[i + 1], c));
+            if (inPlace) { emit dataChanged(index(r), index(r)); return; }
+            beginRemoveRows({}, r, r);
+            rows_.erase(rows_.begin() + r);
+            endRemoveRows();
         }
+        const auto pos = std::lower_bound(rows_.begin(), rows_.end(), c, CourseDirectory::byCode);
+        const int r = int(pos - rows_.begin());
+        beginInsertRows({}, r, r);
+        rows_.insert(pos, c);
+        endInsertRows();
     }
-private slots:
-    void onSave() {
-        QSqlDatabase::database().transaction();
-        if (editCourseId_ < 0) {
-            QSqlQuery ins; ins.prepare(R"(INSERT INTO courses(user_id, semester_id, code, name, color_hex) VALUES(?,?,?,?,?))");
-            ins.addBindValue(userId_); ins.addBindValue(semId_);
-            ins.addBindValue(code_->text()); ins.addBindValue(name_->text());
-            ins.addBindValue(color_->text().isEmpty() ? "#4F46E5" : color_->text());
-            if (ins.exec()) { courseId = ins.lastInsertId().toInt(); QSqlDatabase::database().commit(); accept(); }
-            else { QSqlDatabase::database().rollback(); QMessageBox::warning(this, "Error", "Could not save course."); }
-        } else {
-            QSqlQuery upd; upd.prepare(R"(UPDATE courses SET code=?, name=?, color_hex=? WHERE id=?)");
-            upd.addBindValue(code_->text()); upd.addBindValue(name_->text());
-            upd.addBindValue(color_->text().isEmpty() ? "#4F46E5" : color_->text());
-            upd.addBindValue(editCourseId_);
-            if (upd.exec()) { courseId = editCourseId_; QSqlDatabase::database().commit(); accept(); }
-            else { QSqlDatabase::database().rollback(); QMessageBox::warning(this, "Error", "Could not update course."); }
+    void removeIds(const QList<int>& ids) {
+        for (int r = int(rows_.size()) - 1; r >= 0; --r) {
+            if (!ids.contains(rows_[std::size_t(r)].id)) continue;
+            beginRemoveRows({}, r, r);
+            rows_.erase(rows_.begin() + r);
+            endRemoveRows();
         }
     }
+
 private:
-    int userId_, semId_, editCourseId_{-1};
-    QLineEdit *code_{}, *name_{}, *color_{};
+    std::vector<Course> rows_;
 };
 
-// AssignmentDialog: Add/Edit assignment
-class AssignmentDialog : public QDialog {
+// Timeline tab: weeks as rows, across every course and semester, colored by
+// course. Each visible week is drawn from a cached QImage tile. Data comes in
+// kWindowWeeks-week windows from fetchRange on the read pool, and the windows
+// either side of the viewport are prefetched so scrolling rarely waits.
+// invalidate() drops windows and tiles after any mutation.
+class TimelineView : public QAbstractScrollArea {
     Q_OBJECT
 public:
-    int assignmentId{-1};
-    // Add optional assignmentId for editing
-    AssignmentDialog(int courseId, QWidget* parent=nullptr, int editAssignmentId = -1)
-        : QDialog(parent), courseId_(courseId), editAssignmentId_(editAssignmentId) {
-        setWindowTitle(editAssignmentId_ < 0 ? "Add Assignment" : "Edit Assignment");
-        type_ = new QComboBox; type_->addItems({"HW","Quiz","Midterm","Final","Project","Essay","Other"});
-        title_ = new QLineEdit;
-        dueDate_ = new QDateTimeEdit(QDateTime::currentDateTime()); dueDate_->setCalendarPopup(true);
-        topics_ = new QLineEdit; topics_->setPlaceholderText("Optional: topics/tags");
-        notes_ = new QTextEdit;
+    enum class Zoom { Week, Month };
+    static constexpr int kWindowWeeks = 8;
+    static constexpr int kSpanWeeks = 52 * 12;  // scrollable range, centered on today
+    static constexpr std::size_t kCachedWindows = 24, kCachedTiles = 256;
 
-        auto form = new QFormLayout;
-        form->addRow("Type", type_); form->addRow("Title", title_);
-        form->addRow("Due at", dueDate_); form->addRow("Topics", topics_); form->addRow("Notes", notes_);
-
-        auto ok = new QPushButton("Save");
-        auto v = new QVBoxLayout; v->addLayout(form); v->addWidget(ok); setLayout(v);
-        connect(ok, &QPushButton::clicked, this, &AssignmentDialog::onSave);
-
-        // If editing, load assignment data
-        if (editAssignmentId_ >= 0) {
-            QSqlQuery q; q.prepare("SELECT type, title, due_at_utc, topics, notes FROM assignments WHERE id=?");
-            q.addBindValue(editAssignmentId_);
-            if (q.exec() && q.next()) {
-                type_->setCurrentText(q.value(0).toString());
-                title_->setText(q.value(1).toString());
-                dueDate_->setDateTime(QDateTime::fromSecsSinceEpoch(q.value(2).toLongLong()).toLocalTime());
-                topics_->setText(q.value(3).toString());
-                notes_->setPlainText(q.value(4).toString());
-            }
-        }
+    TimelineView(ConnectionPool& reads, int userId, QWidget* parent=nullptr)
+        : QAbstractScrollArea(parent), reads_(reads), userId_(userId), firstWeek_(weekOf(QDate::currentDate()) - kSpanWeeks / 2) {
+        verticalScrollBar()->setSingleStep(24);
+        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        viewport()->setAutoFillBackground(false);
+        loadSwatches();
     }
-private slots:
-    void onSave() {
-        QSqlDatabase::database().transaction();
-        if (editAssignmentId_ < 0) {
-            QSqlQuery ins; ins.prepare(R"(INSERT INTO assignments(course_id, type, title, due_at_utc, topics, notes)
-                           VALUES(?,?,?,?,?,?))");
-            ins.addBindValue(courseId_);
-            ins.addBindValue(type_->currentText());
-            ins.addBindValue(title_->text());
-            ins.addBindValue(dueDate_->dateTime().toUTC().toSecsSinceEpoch());
-            ins.addBindValue(topics_->text().isEmpty() ? QVariant(QString()) : QVariant(topics_->text()));
-            ins.addBindValue(notes_->toPlainText().isEmpty() ? QVariant(QString()) : QVariant(notes_->toPlainText()));
-            if (ins.exec()) { assignmentId = ins.lastInsertId().toInt(); QSqlDatabase::database().commit(); accept(); }
-            else { QSqlDatabase::database().rollback(); QMessageBox::warning(this, "Error", "Could not save assignment."); }
-        } else {
-            QSqlQuery upd; upd.prepare(R"(UPDATE assignments SET type=?, title=?, due_at_utc=?, topics=?, notes=? WHERE id=?)");
-            upd.addBindValue(type_->currentText());
-            upd.addBindValue(title_->text());
-            upd.addBindValue(dueDate_->dateTime().toUTC().toSecsSinceEpoch());
-            upd.addBindValue(topics_->text().isEmpty() ? QVariant(QString()) : QVariant(topics_->text()));
-            upd.addBindValue(notes_->toPlainText().isEmpty() ? QVariant(QString()) : QVariant(notes_->toPlainText()));
-            upd.addBindValue(editAssignmentId_);
-            if (upd.exec()) { assignmentId = editAssignmentId_; QSqlDatabase::database().commit(); accept(); }
-            else { QSqlDatabase::database().rollback(); QMessageBox::warning(this, "Error", "Could not update assignment."); }
-        }
+
+    void setZoom(Zoom z) {
+        if (z == zoom_) return;
+        const int top = topWeek();
+        zoom_ = z;
+        tiles_.clear();
+        updateScrollRange();
+        verticalScrollBar()->setValue((top - firstWeek_) * rowHeight());
+        viewport()->update();
     }
+    void scrollToToday() { verticalScrollBar()->setValue((weekOf(QDate::currentDate()) - firstWeek_) * rowHeight()); }
+
+    void setUser(int userId) {
+        if (userId == userId_) return;
+        userId_ = userId;
+        invalidate();
+    }
+
+    // Assignments or courses changed: everything cached may be stale.
+    void invalidate() {
+        ++generation_;
+        windows_.clear(); pending_.clear(); tiles_.clear();
+        loadSwatches();
+        viewport()->update();
+    }
+
+signals:
+    void assignmentActivated(int courseId, int assignmentId);
+
+protected:
+    void paintEvent(QPaintEvent*) override {
+        QPainter p(viewport());
+        const int h = rowHeight(), scroll = verticalScrollBar()->value();
+        const int firstRow = scroll / h, lastRow = std::min(kSpanWeeks - 1, (scroll + viewport()->height()) / h);
+        for (int row = firstRow; row <= lastRow; ++row) p.drawImage(0, row * h - scroll, tile(firstWeek_ + row).image);
+        // Neighbouring windows load while the user is still looking at this one
+        if (firstRow > 0) window(windowOf(firstWeek_ + firstRow) - 1);
+        window(windowOf(firstWeek_ + lastRow) + 1);
+    }
+    void resizeEvent(QResizeEvent* e) override {
+        QAbstractScrollArea::resizeEvent(e);
+        if (e->oldSize().width() != e->size().width()) tiles_.clear();
+        const bool first = verticalScrollBar()->maximum() == 0;
+        updateScrollRange();
+        if (first) scrollToToday();
+    }
+    void scrollContentsBy(int, int) override { viewport()->update(); }
+    void mouseDoubleClickEvent(QMouseEvent* e) override {
+        const QPoint pos = e->position().toPoint();
+        const int y = pos.y() + verticalScrollBar()->value();
+        const int week = firstWeek_ + y / rowHeight();
+        if (const Tile* t = tiles_.find(week))
+            for (const auto& hit : t->hits)
+                if (hit.rect.contains(pos.x(), y % rowHeight())) { emit assignmentActivated(hit.courseId, hit.id); return; }
+    }
+
 private:
-    int courseId_, editAssignmentId_{-1};
-    QComboBox* type_{};
-    QLineEdit *title_{}, *topics_{};
-    QDateTimeEdit* dueDate_{};
-    QTextEdit* notes_{};
+    struct Hit { QRect rect; int id, courseId; };
+    struct Tile { QImage image; std::vector<Hit> hits; };
+    struct Window { AssignmentStore items; std::vector<AssignmentStore::Row> byDue; };
+
+    static inline const QDate kEpochMonday{1970, 1, 5};
+    static int weekOf(const QDate& d) { return int(kEpochMonday.daysTo(d) / 7); }
+    static int windowOf(int week) { return week / kWindowWeeks; }
+    static qint64 weekStartUtc(int week) { return QDateTime(kEpochMonday.addDays(qint64(week) * 7), QTime(0, 0)).toSecsSinceEpoch(); }
+
+    int rowHeight() const { return zoom_ == Zoom::Week ? 180 : 84; }
+    int topWeek() const { return firstWeek_ + verticalScrollBar()->value() / rowHeight(); }
+    void updateScrollRange() {
+        verticalScrollBar()->setPageStep(viewport()->height());
+        verticalScrollBar()->setRange(0, std::max(0, kSpanWeeks * rowHeight() - viewport()->height()));
+    }
+
+    void loadSwatches() {
+        reads_.post(this, [u = userId_](SqlRepo& r) { return fetchCourseSwatches(r, u); }, [this, gen = generation_](QHash<int, CourseSwatch> s) {
+            if (gen != generation_) return;  // a newer fetch is in flight; pool jobs may finish out of order
+            swatches_ = std::move(s);
+            tiles_.clear();
+            viewport()->update();
+        });
+    }
+
+    // The cached window, or nullptr after queueing its fetch.
+    const Window* window(int w) {
+        if (const Window* cached = windows_.find(w)) return cached;
+        if (pending_.contains(w)) return nullptr;
+        pending_.insert(w);
+        reads_.post(this, [u = userId_, from = weekStartUtc(w * kWindowWeeks), to = weekStartUtc((w + 1) * kWindowWeeks)](SqlRepo& r) {
+            Window win{fetchRange(r, u, from, to), {}};
+            win.byDue.resize(win.items.size());
+            std::iota(win.byDue.begin(), win.byDue.end(), AssignmentStore::Row(0));
+            std::sort(win.byDue.begin(), win.byDue.end(), [&, later = StoreDueSooner{&win.items}](auto a, auto b) { return later(b, a); });
+            return win;
+        }, [this, w, gen = generation_](Window win) {
+            if (gen != generation_) return;  // invalidated while in flight
+            pending_.remove(w);
+            windows_.put(w, std::move(win));
+            for (int week = w * kWindowWeeks; week < (w + 1) * kWindowWeeks; ++week) tiles_.remove(week);
+            viewport()->update();
+        });
+        return nullptr;
+    }
+
+    // Tiles are only cached once their window has loaded.
+    Tile tile(int week) {
+        if (const Tile* cached = tiles_.find(week)) return *cached;
+        const Window* win = window(windowOf(week));
+        Tile t = render(week, win);
+        if (win) tiles_.put(week, t);
+        return t;
+    }
+
+    Tile render(int week, const Window* win) const {
+        const int w = viewport()->width(), h = rowHeight();
+        Tile t{QImage(std::max(w, 1), h, QImage::Format_ARGB32_Premultiplied), {}};
+        t.image.fill(palette().color(QPalette::Base));
+        QPainter p(&t.image);
+        QFont small = font(); small.setPointSizeF(small.pointSizeF() * (zoom_ == Zoom::Week ? 0.9 : 0.8));
+        p.setFont(small);
+        const QFontMetrics fm(small);
+        const int line = fm.height() + 2;
+        const QDate monday = kEpochMonday.addDays(qint64(week) * 7), today = QDate::currentDate();
+        const qint64 weekEnd = weekStartUtc(week + 1);
+        // Rows of this week within the window, in due order
+        auto it = win ? std::partition_point(win->byDue.begin(), win->byDue.end(), [&](auto r) { return win->items.due(r) < weekStartUtc(week); })
+                      : std::vector<AssignmentStore::Row>::const_iterator{};
+        for (int d = 0; d < 7; ++d) {
+            const QDate day = monday.addDays(d);
+            const QRect cell(d * w / 7, 0, (d + 1) * w / 7 - d * w / 7, h);
+            if (day == today) p.fillRect(cell, QColor(255, 248, 214));
+            else if (d >= 5) p.fillRect(cell, palette().color(QPalette::AlternateBase));
+            p.setPen(palette().color(QPalette::Mid));
+            p.drawRect(cell.adjusted(0, 0, d == 6 ? -1 : 0, -1));
+            p.setPen(palette().color(day.month() % 2 ? QPalette::Text : QPalette::PlaceholderText));
+            const QString label = day.day() == 1 || d == 0 ? uiLocale().toString(day, QStringLiteral("d MMM")) : QString::number(day.day());
+            p.drawText(cell.adjusted(4, 2, -4, 0), Qt::AlignLeft | Qt::AlignTop,
+                       zoom_ == Zoom::Week ? uiLocale().toString(day, QStringLiteral("ddd ")) + label : label);
+            if (!win) continue;
+            const qint64 dayEnd = d == 6 ? weekEnd : QDateTime(day.addDays(1), QTime(0, 0)).toSecsSinceEpoch();
+            int y = line + 2, hidden = 0;
+            for (; it != win->byDue.end() && win->items.due(*it) < dayEnd; ++it) {
+                const auto r = *it;
+                if (y + 2 * line > h) { ++hidden; continue; }  // the last line is kept for "+N more"
+                const auto sw = swatches_.constFind(win->items.courseId(r));
+                const QColor color = sw != swatches_.cend() ? sw->color : QColor(0x4F, 0x46, 0xE5);
+                const QRect chip(cell.x() + 3, y, cell.width() - 6, line - 2);
+                p.fillRect(chip, color);
+                p.setPen(qGray(color.rgb()) > 150 ? Qt::black : Qt::white);
+                const QString text = zoom_ == Zoom::Week
+                    ? QString("%1 %2").arg(sw != swatches_.cend() ? sw->code : QString(), win->items.title(r).toString())
+                    : (sw != swatches_.cend() ? sw->code : win->items.title(r).toString());
+                p.drawText(chip.adjusted(3, 0, -3, 0), Qt::AlignVCenter | Qt::AlignLeft, fm.elidedText(text, Qt::ElideRight, chip.width() - 6));
+                t.hits.push_back({chip, win->items.id(r), win->items.courseId(r)});
+                y += line;
+            }
+            if (hidden) {
+                p.setPen(palette().color(QPalette::Text));
+                p.drawText(cell.adjusted(4, 0, -4, -2), Qt::AlignLeft | Qt::AlignBottom, QString("+%1 more").arg(hidden));
+            }
+        }
+        return t;
+    }
+
+    ConnectionPool& reads_;
+    int userId_;
+    int firstWeek_;
+    Zoom zoom_{Zoom::Week};
+    quint64 generation_{0};
+    QHash<int, CourseSwatch> swatches_;
+    LruCache<int, Window> windows_{kCachedWindows};
+    QSet<int> pending_;
+    LruCache<int, Tile> tiles_{kCachedTiles};
 };
 
-// MainWindow: Dashboard
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
-    explicit MainWindow(int userId, QWidget* parent=nullptr) : QMainWindow(parent), userId_(userId) {
+    explicit MainWindow(int userId, QWidget* parent=nullptr) : QMainWindow(parent), userId_(userId), db_(DbWorker::shared()), reads_(ConnectionPool::shared()) {
         setWindowTitle("CoursePilot (single-file)");
         resize(980, 640);
 
         // Left column: courses list + add, edit, delete buttons
-        courses_ = new QListWidget; courses_->setSelectionMode(QAbstractItemView::SingleSelection);
+        courseModel_ = new CourseListModel(this);
+        courses_ = new QListView; courses_->setModel(courseModel_);
+        courses_->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        courses_->setUniformItemSizes(true);
         auto btnAddCourse = new QPushButton("Add Course");
         auto btnEditCourse = new QPushButton("Edit Course");
         auto btnDeleteCourse = new QPushButton("Delete Course");
         auto left = new QVBoxLayout;
-        left->addWidget(new QLabel("Courses"));
+        coursesLabel_ = new QLabel("Courses");
+        left->addWidget(coursesLabel_);
         left->addWidget(courses_);
         left->addWidget(btnAddCourse);
         left->addWidget(btnEditCourse);
         left->addWidget(btnDeleteCourse);
 
         // Center column: assignments table + add, edit, delete buttons
-        assigns_ = new QTableWidget(0, 4);
-        assigns_->setHorizontalHeaderLabels({"Type","Title","Due (local)","Topics"});
+        assignModel_ = new AssignmentTableModel(reads_, this);
+        assignProxy_ = new QSortFilterProxyModel(this);
+        assignProxy_->setSourceModel(assignModel_);
+        assignProxy_->setSortRole(AssignmentTableModel::SortRole);
+        assignProxy_->setFilterKeyColumn(-1);
+        assignProxy_->setFilterCaseSensitivity(Qt::CaseInsensitive);
+        assigns_ = new QTableView;
+        assigns_->setModel(assignProxy_);
         assigns_->horizontalHeader()->setStretchLastSection(true);
+        assigns_->verticalHeader()->hide();
         assigns_->setSelectionBehavior(QAbstractItemView::SelectRows);
+        assigns_->setSelectionMode(QAbstractItemView::ExtendedSelection);
         assigns_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        assigns_->setSortingEnabled(true);
+        assigns_->sortByColumn(AssignmentTableModel::ColDue, Qt::AscendingOrder);
+        assignFilter_ = new QLineEdit; assignFilter_->setPlaceholderText("Filter assignments…");
+        assignFilter_->setClearButtonEnabled(true);
         auto btnAddAssign = new QPushButton("Add Assignment");
         auto btnEditAssign = new QPushButton("Edit Assignment");
         auto btnDeleteAssign = new QPushButton("Delete Assignment");
         auto center = new QVBoxLayout;
-        center->addWidget(new QLabel("Assignments"));
+        assignsLabel_ = new QLabel("Assignments");
+        center->addWidget(assignsLabel_);
+        center->addWidget(assignFilter_);
         center->addWidget(assigns_);
         center->addWidget(btnAddAssign);
         center->addWidget(btnEditAssign);
@@ -372,24 +4235,85 @@ public:
 
         // Right column: Upcoming list (min-heap feed) + refresh
         upcoming_ = new QListWidget;
+        upcomingLimit_ = new QSpinBox; upcomingLimit_->setRange(1, 500); upcomingLimit_->setValue(kDefaultUpcomingLimit);
         auto refreshUpcoming = new QPushButton("Refresh Upcoming");
-        auto right = new QVBoxLayout; right->addWidget(new QLabel("Upcoming (soonest first)")); right->addWidget(upcoming_); right->addWidget(refreshUpcoming);
+        upcomingOrder_ = new QComboBox; upcomingOrder_->addItems({"Soonest", "Most urgent"});
+        upcomingOrder_->setToolTip("Most urgent weighs type, effort, and course load against the time left");
+        upcomingOrder_->setCurrentIndex(QSettings(settingsPath(), QSettings::IniFormat).value("upcoming/order").toString() == "urgent" ? 1 : 0);
+        auto limitRow = new QHBoxLayout; limitRow->addWidget(new QLabel("Show")); limitRow->addWidget(upcomingLimit_);
+        limitRow->addWidget(upcomingOrder_); limitRow->addStretch();
+        upcomingLabel_ = new QLabel;
+        auto right = new QVBoxLayout; right->addWidget(upcomingLabel_); right->addWidget(upcoming_);
+        right->addLayout(limitRow); right->addWidget(refreshUpcoming);
+        conflictsLabel_ = new QLabel("Conflicts");
+        conflicts_ = new QListWidget; conflicts_->setMaximumHeight(140);
+        right->addWidget(conflictsLabel_); right->addWidget(conflicts_);
 
         // Top: term/year pickers
         term_ = new QComboBox; term_->addItems({"Fall","Spring"});
         year_ = new QSpinBox; year_->setRange(2022, 2042); year_->setValue(QDate::currentDate().year());
         auto btnSelectSem = new QPushButton("Use Semester");
+        search_ = new QLineEdit; search_->setPlaceholderText("Search titles, topics, notes…");
+        search_->setClearButtonEnabled(true); search_->setMinimumWidth(260);
         auto top = new QHBoxLayout; top->addWidget(new QLabel("Term:")); top->addWidget(term_);
         top->addWidget(new QLabel("Year:")); top->addWidget(year_); top->addWidget(btnSelectSem); top->addStretch();
+        top->addWidget(search_);
+
+        // Search results: hidden until there is a query
+        searchResults_ = new QListWidget; searchResults_->setMaximumHeight(160); searchResults_->hide();
+        searchDebounce_.setSingleShot(true);
+        searchDebounce_.setInterval(150);
 
         // Grid layout
         auto grid = new QGridLayout;
         grid->addLayout(top, 0, 0, 1, 3);
-        grid->addLayout(left, 1, 0);
-        grid->addLayout(center, 1, 1);
-        grid->addLayout(right, 1, 2);
+        grid->addWidget(searchResults_, 1, 0, 1, 3);
+        grid->addLayout(left, 2, 0);
+        grid->addLayout(center, 2, 1);
+        grid->addLayout(right, 2, 2);
+
+        auto w = new QWidget; w->setLayout(grid);
 
-        auto w = new QWidget; w->setLayout(grid); setCentralWidget(w);
+        // Timeline tab: all courses and semesters on one scrollable calendar
+        timeline_ = new TimelineView(reads_, userId_);
+        auto zoom = new QComboBox; zoom->addItems({"Week", "Month"});
+        auto btnToday = new QPushButton("Today");
+        auto timelineBar = new QHBoxLayout; timelineBar->addWidget(new QLabel("Zoom:")); timelineBar->addWidget(zoom);
+        timelineBar->addWidget(btnToday); timelineBar->addStretch();
+        auto timelinePage = new QWidget;
+        auto timelineLayout = new QVBoxLayout(timelinePage); timelineLayout->addLayout(timelineBar); timelineLayout->addWidget(timeline_);
+        connect(zoom, &QComboBox::currentIndexChanged, this, [this](int i) { timeline_->setZoom(i == 0 ? TimelineView::Zoom::Week : TimelineView::Zoom::Month); });
+        connect(btnToday, &QPushButton::clicked, timeline_, &TimelineView::scrollToToday);
+        connect(timeline_, &TimelineView::assignmentActivated, this, &MainWindow::openFromTimeline);
+
+        auto tabs = new QTabWidget;
+        tabs->addTab(w, "Dashboard");
+        tabs->addTab(timelinePage, "Timeline");
+        setCentralWidget(tabs);
+
+        // Menu bar
+        auto fileMenu = menuBar()->addMenu("&File");
+        importAct_ = fileMenu->addAction("&Import Assignments…", this, &MainWindow::importAssignmentsFile);
+        exportAct_ = fileMenu->addAction("&Export Semester…", this, &MainWindow::exportSemesterFile);
+        fileMenu->addSeparator();
+        archiveAct_ = fileMenu->addAction("&Archive Semester…", this, &MainWindow::archiveCurrentSemester);
+        restoreAct_ = fileMenu->addAction("&Restore Semester", this, [this] { moveCurrentSemester(false); });
+        fileMenu->addSeparator();
+        fileMenu->addAction("S&ync Now", this, [this] { syncNow(true); });
+        fileMenu->addSeparator();
+        fileMenu->addAction("S&witch User…", this, &MainWindow::switchUser);
+        fileMenu->addAction("&Quit", QKeySequence::Quit, this, &QWidget::close);
+        auto debugMenu = menuBar()->addMenu("&Debug");
+        debugMenu->addAction("&Startup Timings…", this, [this] {
+            QMessageBox box(QMessageBox::Information, "Startup Timings", "Phases since launch:", QMessageBox::Ok, this);
+            box.setDetailedText(StartupTrace::instance().report());
+            box.exec();
+        });
+        debugMenu->addAction("Database &Contention…", this, [this] {
+            QMessageBox::information(this, "Database Contention",
+                ContentionStats::instance().summary() + QString("\nOpen read connections: %1").arg(ConnectionPool::openConnections()));
+        });
+        debugMenu->addAction("&Diagnostics…", this, [this] { DiagnosticsDialog(this).exec(); });
 
         // Wire actions
         connect(btnSelectSem, &QPushButton::clicked, this, &MainWindow::pickSemester);
@@ -399,11 +4323,77 @@ public:
         connect(btnAddAssign, &QPushButton::clicked, this, &MainWindow::addAssignment);
         connect(btnEditAssign, &QPushButton::clicked, this, &MainWindow::editAssignment);
         connect(btnDeleteAssign, &QPushButton::clicked, this, &MainWindow::deleteAssignment);
-        connect(courses_, &QListWidget::itemSelectionChanged, this, &MainWindow::loadAssignments);
-        connect(refreshUpcoming, &QPushButton::clicked, this, &MainWindow::reloadUpcoming);
+        editButtons_ = {btnAddCourse, btnEditCourse, btnDeleteCourse, btnAddAssign, btnEditAssign, btnDeleteAssign};
+        updateArchiveUi();
+        connect(courses_->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this] { refresh_.settle(RefreshScheduler::Assignments); });
+        connect(refreshUpcoming, &QPushButton::clicked, this, [this] { refresh_.mark(RefreshScheduler::Upcoming); });
+        connect(assignFilter_, &QLineEdit::textChanged, assignProxy_, &QSortFilterProxyModel::setFilterFixedString);
+        connect(assignFilter_, &QLineEdit::textChanged, this, &MainWindow::updateAssignDrain);
+        connect(assigns_->horizontalHeader(), &QHeaderView::sortIndicatorChanged, this, &MainWindow::updateAssignDrain);
+        connect(upcomingLimit_, &QSpinBox::valueChanged, this, [this] { refresh_.mark(RefreshScheduler::Upcoming); });
+        connect(upcomingOrder_, &QComboBox::currentIndexChanged, this, [this] {
+            QSettings(settingsPath(), QSettings::IniFormat).setValue("upcoming/order", urgentFirst() ? "urgent" : "soonest");
+            refresh_.mark(RefreshScheduler::Upcoming);
+        });
+        refresh_.flush = [this](unsigned views) { refreshViews(views); };
+        connect(search_, &QLineEdit::textChanged, &searchDebounce_, qOverload<>(&QTimer::start));
+        connect(&searchDebounce_, &QTimer::timeout, this, &MainWindow::runSearch);
+        connect(searchResults_, &QListWidget::itemActivated, this, &MainWindow::openSearchHit);
+
+        // A delta usually removes one row and inserts another, so removed items
+        // wait in a few spare slots for the next insert instead of being freed.
+        upcomingIdx_.inserted = [this](int row, const Assignment& a) {
+            std::unique_ptr<QListWidgetItem> it;
+            if (spareUpcoming_.empty()) it = std::make_unique<QListWidgetItem>();
+            else { it = std::move(spareUpcoming_.back()); spareUpcoming_.pop_back(); }
+            it->setText(upcomingText(a));
+            upcoming_->insertItem(row, it.release());
+            reminders_.upsert(a);
+        };
+        upcomingIdx_.removed = [this](int row, int id) {
+            std::unique_ptr<QListWidgetItem> it(upcoming_->takeItem(row));
+            if (it && spareUpcoming_.size() < 4) spareUpcoming_.push_back(std::move(it));
+            reminders_.remove(id);
+        };
+
+        // Due-date reminders go to the tray, or the status bar where there is no tray
+        tray_ = new QSystemTrayIcon(style()->standardIcon(QStyle::SP_FileDialogDetailedView), this);
+        tray_->setToolTip("CoursePilot");
+        if (QSystemTrayIcon::isSystemTrayAvailable()) tray_->show();
+        ReminderLeads leads;
+        leads.load(QSettings(settingsPath(), QSettings::IniFormat));
+        reminders_.setLeads(leads);
+        reminders_.fired = [this](const std::vector<Assignment>& due) { notifyDue(due); };
+
+        // Background sync every [sync] interval_min minutes, when a directory is set
+        const int syncMinutes = QSettings(settingsPath(), QSettings::IniFormat).value("sync/interval_min", 0).toInt();
+        if (syncMinutes > 0) {
+            syncTimer_.setTimerType(Qt::VeryCoarseTimer);
+            connect(&syncTimer_, &QTimer::timeout, this, [this] { syncNow(false); });
+            syncTimer_.start(std::chrono::minutes(syncMinutes));
+        }
+
+        // Resident size readout, so growth over a long-running session is visible
+        memLabel_ = new QLabel;
+        statusBar()->addPermanentWidget(memLabel_);
+        memTimer_.setTimerType(Qt::VeryCoarseTimer);
+        connect(&memTimer_, &QTimer::timeout, this, &MainWindow::updateMemoryReadout);
+        memTimer_.start(std::chrono::seconds(30));
+        memBudget_ = QSettings(settingsPath(), QSettings::IniFormat).value("memory/budget_mb", kDefaultMemoryBudgetMb).toLongLong() * 1024 * 1024;
+        updateMemoryReadout();
+
+        StartupTrace::instance().mark("main window built");
+        // The semester prompt (and with it every dashboard query) waits for first paint.
+    }
 
-        // Prompt for the first semester
-        pickSemester();
+protected:
+    bool event(QEvent* e) override {
+        if (e->type() == QEvent::Paint && !firstPaintDone_) {
+            firstPaintDone_ = true;
+            StartupTrace::instance().mark("first paint");
+            QTimer::singleShot(0, this, &MainWindow::pickSemester);
+        }
+        return QMainWindow::event(e);
     }
 
 private slots:
@@ -411,165 +4401,1144 @@ private slots:
         SemesterPicker sp(this);
         if (sp.exec() == QDialog::Accepted && sp.semesterId > 0) {
             semesterId_ = sp.semesterId;
-            loadSemesterIntoControls();
-            loadCourses();
-            reloadUpcoming();
+            loadSemesterIntoControls([this] {
+                refresh_.mark(RefreshScheduler::Courses | RefreshScheduler::Upcoming | RefreshScheduler::Conflicts | RefreshScheduler::Search);
+            });
         }
     }
 
     void addCourse() {
         if (semesterId_ < 0) { QMessageBox::information(this,"Select semester","Pick a semester first."); return; }
         CourseDialog cd(userId_, semesterId_, this);
-        if (cd.exec() == QDialog::Accepted) loadCourses();
+        if (cd.exec() == QDialog::Accepted) courseSaved(cd.saved());
     }
 
     void editCourse() {
-        auto *item = courses_->currentItem();
-        if (!item) { QMessageBox::information(this,"Edit course","Select a course."); return; }
-        int courseId = item->data(Qt::UserRole).toInt();
+        const int courseId = currentCourseId();
+        if (courseId < 0) { QMessageBox::information(this,"Edit course","Select a course."); return; }
         CourseDialog cd(userId_, semesterId_, this, courseId);
-        if (cd.exec() == QDialog::Accepted) loadCourses();
+        if (cd.exec() == QDialog::Accepted) { courseSaved(cd.saved()); refreshUpcomingTexts(); }
+    }
+
+    void courseSaved(const Course& c) {
+        courseCache_.remove(c.semesterId);
+        timeline_->invalidate();
+        courseDir_.upsert(c);
+        courseModel_->upsert(c);
+        selectCourse(c.id);
     }
 
     void deleteCourse() {
-        auto *item = courses_->currentItem();
-        if (!item) { QMessageBox::information(this,"Delete course","Select a course."); return; }
-        int courseId = item->data(Qt::UserRole).toInt();
-        if (QMessageBox::question(this, "Delete Course", "Are you sure you want to delete this course and all its assignments?") == QMessageBox::Yes) {
-            QSqlDatabase::database().transaction();
-            QSqlQuery delAssigns; delAssigns.prepare("DELETE FROM assignments WHERE course_id=?");
-            delAssigns.addBindValue(courseId); delAssigns.exec();
-            QSqlQuery delCourse; delCourse.prepare("DELETE FROM courses WHERE id=?");
-            delCourse.addBindValue(courseId); delCourse.exec();
-            QSqlDatabase::database().commit();
-            loadCourses(); reloadUpcoming();
+        const QList<int> ids = selectedCourseIds();
+        if (ids.isEmpty()) { QMessageBox::information(this,"Delete course","Select a course."); return; }
+        const QString what = ids.size() == 1 ? QString("this course") : QString("these %1 courses").arg(ids.size());
+        if (QMessageBox::question(this, "Delete Course", QString("Are you sure you want to delete %1 and all their assignments?").arg(what)) == QMessageBox::Yes) {
+            db_.post(this, [ids](SqlRepo& r) { return deleteCourseRows(r, ids); }, [this, ids, sem = semesterId_](bool ok) {
+                if (!ok) { QMessageBox::warning(this, "Error", "Could not delete course."); return; }
+                courseCache_.remove(sem);
+                timeline_->invalidate();
+                for (int id : ids) { courseDir_.remove(id); upcomingIdx_.removeCourse(id); }
+                courseModel_->removeIds(ids);
+                selectCourse(-1);
+                refillUpcoming();
+                scheduleCoursesRemoved(ids);
+            });
         }
     }
 
     void addAssignment() {
-        auto *item = courses_->currentItem();
-        if (!item) { QMessageBox::information(this,"Add assignment","Select a course."); return; }
-        const int courseId = item->data(Qt::UserRole).toInt();
+        const int courseId = currentCourseId();
+        if (courseId < 0) { QMessageBox::information(this,"Add assignment","Select a course."); return; }
         AssignmentDialog ad(courseId, this);
-        if (ad.exec() == QDialog::Accepted) { loadAssignments(); reloadUpcoming(); }
+        if (ad.exec() != QDialog::Accepted) return;
+        refresh_.mark(RefreshScheduler::Assignments);
+        timeline_->invalidate();
+        if (ad.seriesId >= 0) { refresh_.mark(RefreshScheduler::Upcoming | RefreshScheduler::Conflicts); return; }  // occurrences only exist expanded
+        upcomingChanged(ad.saved()); scheduleChanged(ad.saved().id, ad.saved());
     }
 
     void editAssignment() {
-        auto *item = courses_->currentItem();
-        if (!item) { QMessageBox::information(this,"Edit assignment","Select a course."); return; }
-        int courseId = item->data(Qt::UserRole).toInt();
-        int row = assigns_->currentRow();
-        if (row < 0) { QMessageBox::information(this,"Edit assignment","Select an assignment."); return; }
-        int assignId = assigns_->item(row, 0)->data(Qt::UserRole).toInt();
-        AssignmentDialog ad(courseId, this, assignId);
-        if (ad.exec() == QDialog::Accepted) { loadAssignments(); reloadUpcoming(); }
+        const int courseId = currentCourseId();
+        if (courseId < 0) { QMessageBox::information(this,"Edit assignment","Select a course."); return; }
+        const int assignId = selectedAssignmentId();
+        if (assignId == -1) { QMessageBox::information(this,"Edit assignment","Select an assignment."); return; }
+        openAssignment(courseId, assignId);
+    }
+
+    // Search-as-you-type: debounced, and a newer query supersedes any in flight.
+    // Superseded jobs still queued on the pool return without touching SQLite.
+    void runSearch() {
+        const quint64 gen = ++*searchGen_;
+        const QString text = search_->text().trimmed();
+        if (text.isEmpty() || semesterId_ < 0) { searchResults_->clear(); searchResults_->hide(); return; }
+        reads_.post(this, [latest = searchGen_, gen, u = userId_, sem = semesterId_, text](SqlRepo& r) {
+            if (latest->load() != gen) return std::vector<SearchHit>{};
+            return searchAssignments(r, u, sem, text);
+        }, [this, gen](std::vector<SearchHit> hits) {
+            if (gen != searchGen_->load()) return;
+            Metrics::Scope scope("ui.search");
+            int row = 0;
+            for (const auto& h : hits) {
+                auto* it = listRow(searchResults_, row++);
+                it->setText(u'[' % toString(h.type) % u"] " % courseDir_.code(h.courseId) % u" — " % h.title
+                            % u" (" % shortDateTime(h.dueAtUtc) % u")  •  " % h.snippet);
+                it->setData(Qt::UserRole, h.id);
+                it->setData(Qt::UserRole + 1, h.courseId);
+            }
+            if (hits.empty()) {
+                auto* it = listRow(searchResults_, row++);
+                it->setText(QStringLiteral("No matches"));
+                it->setData(Qt::UserRole, QVariant()); it->setData(Qt::UserRole + 1, QVariant());
+            }
+            trimList(searchResults_, row);
+            searchResults_->show();
+        });
+    }
+
+    void openSearchHit(QListWidgetItem* item) {
+        const QVariant id = item->data(Qt::UserRole);
+        if (!id.isValid()) return;  // the "No matches" row
+        const int assignId = id.toInt(), courseId = item->data(Qt::UserRole + 1).toInt();
+        if (const int row = courseModel_->rowOf(courseId); row >= 0) courses_->setCurrentIndex(courseModel_->index(row));
+        openAssignment(courseId, assignId);
     }
 
     void deleteAssignment() {
-        auto *item = courses_->currentItem();
-        if (!item) { QMessageBox::information(this,"Delete assignment","Select a course."); return; }
-        int row = assigns_->currentRow();
-        if (row < 0) { QMessageBox::information(this,"Delete assignment","Select an assignment."); return; }
-        int assignId = assigns_->item(row, 0)->data(Qt::UserRole).toInt();
-        if (QMessageBox::question(this, "Delete Assignment", "Are you sure you want to delete this assignment?") == QMessageBox::Yes) {
-            QSqlQuery del; del.prepare("DELETE FROM assignments WHERE id=?");
-            del.addBindValue(assignId); del.exec();
-            loadAssignments(); reloadUpcoming();
+        if (currentCourseId() < 0) { QMessageBox::information(this,"Delete assignment","Select a course."); return; }
+        const QList<int> ids = selectedAssignmentIds();
+        if (ids.isEmpty()) { QMessageBox::information(this,"Delete assignment","Select an assignment."); return; }
+        const QString what = ids.size() == 1 ? QString("this assignment") : QString("these %1 assignments").arg(ids.size());
+        bool wholeSeries = false;
+        if (std::any_of(ids.begin(), ids.end(), isOccurrenceId)) {
+            QMessageBox box(QMessageBox::Question, "Delete Assignment",
+                            QString("Delete %1, or every date of the weekly series involved?").arg(what), QMessageBox::Cancel, this);
+            auto* only = box.addButton("Only Selected", QMessageBox::YesRole);
+            auto* series = box.addButton("Entire Series", QMessageBox::DestructiveRole);
+            box.exec();
+            if (box.clickedButton() != only && box.clickedButton() != series) return;
+            wholeSeries = box.clickedButton() == series;
+        } else if (QMessageBox::question(this, "Delete Assignment", QString("Are you sure you want to delete %1?").arg(what)) != QMessageBox::Yes) {
+            return;
         }
+        db_.post(this, [ids, wholeSeries](SqlRepo& r) { return deleteAssignmentRows(r, ids, wholeSeries); }, [this, ids, wholeSeries](bool ok) {
+            if (!ok) { QMessageBox::warning(this, "Error", "Could not delete assignment."); return; }
+            timeline_->invalidate();
+            if (wholeSeries) { refresh_.mark(RefreshScheduler::Assignments | RefreshScheduler::Upcoming | RefreshScheduler::Conflicts); return; }
+            assignModel_->removeIds(ids);
+            for (int id : ids) upcomingIdx_.remove(id);
+            refillUpcoming();
+            scheduleRemoved(ids);
+        });
+    }
+
+    void importAssignmentsFile() {
+        if (semesterId_ < 0) { QMessageBox::information(this,"Import","Pick a semester first."); return; }
+        const QString path = QFileDialog::getOpenFileName(this, "Import Assignments", QString(),
+                                                          "Syllabus exports (*.csv *.ics);;CSV (*.csv);;iCalendar (*.ics)");
+        if (path.isEmpty()) return;
+        ImportOptions opt;
+        opt.userId = userId_; opt.semesterId = semesterId_;
+        opt.defaultCourseId = currentCourseId();
+
+        auto cancel = std::make_shared<std::atomic_bool>(false);
+        auto* progress = new QProgressDialog("Importing " + QFileInfo(path).fileName() + "…", "Cancel", 0, 1000, this);
+        progress->setWindowModality(Qt::WindowModal);
+        progress->setMinimumDuration(300);
+        progress->setAutoClose(false); progress->setAutoReset(false);
+        connect(progress, &QProgressDialog::canceled, this, [cancel] { cancel->store(true); });
+        QPointer<QProgressDialog> guard(progress);
+        startImport(this, path, opt, cancel,
+            [guard](int permille) { if (guard) guard->setValue(permille); },
+            [this, guard, sem = semesterId_](ImportResult res) {
+                if (guard) guard->deleteLater();
+                if (!res.error.isEmpty()) { QMessageBox::warning(this, "Import failed", res.error); return; }
+                if (res.cancelled) return;
+                courseCache_.remove(sem);  // the import may have created courses
+                timeline_->invalidate();
+                if (sem == semesterId_) refresh_.mark(RefreshScheduler::Courses | RefreshScheduler::Upcoming | RefreshScheduler::Conflicts);
+                QString msg = QString("Imported %1 assignment(s).").arg(res.inserted);
+                if (res.coursesCreated) msg += QString(" Created %1 course(s).").arg(res.coursesCreated);
+                if (res.skipped) msg += QString("\nSkipped %1 row(s):\n").arg(res.skipped) + res.problems.join("\n");
+                QMessageBox::information(this, "Import", msg);
+            });
+    }
+
+    void exportSemesterFile() {
+        if (semesterId_ < 0) { QMessageBox::information(this,"Export","Pick a semester first."); return; }
+        const QString path = QFileDialog::getSaveFileName(this, "Export Semester",
+            QString("%1-%2.csv").arg(term_->currentText()).arg(year_->value()),
+            "CSV (*.csv);;iCalendar (*.ics);;JSON Lines (*.jsonl)");
+        if (path.isEmpty()) return;
+        const ExportScope scope{userId_, semesterId_};
+        auto cancel = std::make_shared<std::atomic_bool>(false);
+        auto* progress = new QProgressDialog("Exporting " + QFileInfo(path).fileName() + "…", "Cancel", 0, 0, this);
+        progress->setWindowModality(Qt::WindowModal);
+        progress->setMinimumDuration(300);
+        connect(progress, &QProgressDialog::canceled, this, [cancel] { cancel->store(true); });
+        QPointer<QProgressDialog> guard(progress);
+        runOnPoolConnection(this, [path, scope, cancel](SqlRepo& repo) {
+            if (!repo.db().isOpen()) return ExportResult{0, false, "Cannot open database connection."};
+            return exportToFile(repo, path, exportFormatForPath(path), scope, cancel.get());
+        }, [this, guard](ExportResult res) {
+            if (guard) guard->deleteLater();
+            if (!res.error.isEmpty()) QMessageBox::warning(this, "Export failed", res.error);
+            else if (!res.cancelled) statusBar()->showMessage(QString("Exported %1 assignment(s).").arg(res.rows), 5000);
+        });
+    }
+
+    // Everything RefreshScheduler collected this turn. A course reload ends by
+    // selecting a row, which marks Assignments for the next turn by itself.
+    void refreshViews(unsigned views) {
+        if (views & RefreshScheduler::Courses) loadCourses();
+        else if (views & RefreshScheduler::Assignments) loadAssignments();
+        if (views & RefreshScheduler::Upcoming) reloadUpcoming();
+        if (views & RefreshScheduler::Conflicts) reloadConflicts();
+        if (views & RefreshScheduler::Search) runSearch();
     }
 
+    // Revisited semesters come from courseCache_ without touching SQLite; an
+    // entry is dropped whenever a save, delete or import changes that semester.
     void loadCourses() {
-        courses_->clear(); if (semesterId_ < 0) return;
-        QSqlQuery q; q.prepare("SELECT id, code, name FROM courses WHERE user_id=? AND semester_id=? ORDER BY code");
-        q.addBindValue(userId_); q.addBindValue(semesterId_);
-        if (q.exec()) while (q.next()) {
-            auto *it = new QListWidgetItem(QString("%1 — %2").arg(q.value(1).toString(), q.value(2).toString()));
-            it->setData(Qt::UserRole, q.value(0).toInt());
-            courses_->addItem(it);
-        }
-        if (courses_->count() > 0) { courses_->setCurrentRow(0); loadAssignments(); }
-        else { assigns_->setRowCount(0); }
+        const quint64 gen = ++*coursesGen_;  // also drops a fetch still in flight for another term
+        if (semesterId_ < 0) { showCourses(-1, {}); return; }
+        if (const auto* cached = courseCache_.find(semesterId_)) { showCourses(semesterId_, *cached); return; }
+        showCourses(semesterId_, {});  // no rows from the previous term while this one loads
+        reads_.post(this, [latest = coursesGen_, gen, u = userId_, sem = semesterId_](SqlRepo& r) {
+            if (latest->load() != gen) return std::vector<Course>{};  // superseded while queued
+            return fetchCourses(r, u, sem);
+        }, [this, gen, sem = semesterId_](std::vector<Course> rows) {
+            if (gen != coursesGen_->load()) return;  // pool reads can finish out of order
+            courseCache_.put(sem, rows);
+            showCourses(sem, std::move(rows));
+            StartupTrace::instance().markOnce("courses loaded");
+        }, source());
+    }
+
+    void showCourses(int semesterId, std::vector<Course> rows) {
+        Metrics::Scope scope("ui.courses");
+        courseDir_.reset(semesterId);
+        for (const auto& c : rows) courseDir_.upsert(c);
+        courseModel_->setCourses(std::move(rows));
+        selectCourse(-1);
+    }
+
+    // Selects selectId (or the first row) and shows its assignments.
+    void selectCourse(int selectId) {
+        if (courseModel_->rowCount() == 0) { assignModel_->setCourse(-1); assignsLabel_->setText("Assignments"); return; }
+        courses_->setCurrentIndex(courseModel_->index(std::max(courseModel_->rowOf(selectId), 0)));
+        refresh_.mark(RefreshScheduler::Assignments);  // also absorbs the settle() from selectionChanged
+    }
+
+    int currentCourseId() const {
+        const auto idx = courses_->currentIndex();
+        return idx.isValid() ? courseModel_->idAt(idx.row()) : -1;
+    }
+
+    QList<int> selectedCourseIds() const {
+        QList<int> ids;
+        for (const auto& idx : courses_->selectionModel()->selectedRows()) ids << courseModel_->idAt(idx.row());
+        return ids;
     }
 
     void loadAssignments() {
-        assigns_->setRowCount(0);
-        auto *item = courses_->currentItem(); if (!item) return;
-        const int courseId = item->data(Qt::UserRole).toInt();
-        QSqlQuery q; q.prepare(R"(SELECT id, type, title, due_at_utc, topics
-                     FROM assignments WHERE course_id=? ORDER BY due_at_utc)");
-        q.addBindValue(courseId);
-        if (q.exec()) { int row = 0; while (q.next()) {
-            assigns_->insertRow(row);
-            assigns_->setItem(row, 0, new QTableWidgetItem(q.value(1).toString()));
-            assigns_->item(row, 0)->setData(Qt::UserRole, q.value(0).toInt()); // Store assignment id for edit/delete
-            assigns_->setItem(row, 1, new QTableWidgetItem(q.value(2).toString()));
-            const auto dt = QDateTime::fromSecsSinceEpoch(q.value(3).toLongLong()).toLocalTime();
-            assigns_->setItem(row, 2, new QTableWidgetItem(QLocale().toString(dt, QLocale::ShortFormat)));
-            assigns_->setItem(row, 3, new QTableWidgetItem(q.value(4).toString()));
-            row++;
-        }}
+        const Course* course = courseDir_.find(currentCourseId());
+        assignsLabel_->setText(course ? QString("Assignments — %1").arg(course->code) : QString("Assignments"));
+        assignModel_->setCourse(course ? course->id : -1, source());
+    }
+
+    void openAssignment(int courseId, int assignId) {
+        AssignmentDialog ad(courseId, this, assignId);
+        if (ad.exec() == QDialog::Accepted) {
+            refresh_.mark(RefreshScheduler::Assignments);
+            timeline_->invalidate();
+            if (isOccurrenceId(assignId)) { upcomingIdx_.remove(assignId); scheduleRemoved({assignId}); }  // now a row of its own
+            upcomingChanged(ad.saved()); scheduleChanged(ad.saved().id, ad.saved());
+            if (searchResults_->isVisible()) refresh_.mark(RefreshScheduler::Search);
+        }
+    }
+
+    // Items from other semesters only appear on the timeline, so only it is refreshed.
+    void openFromTimeline(int courseId, int assignId) {
+        if (courseDir_.find(courseId)) { openAssignment(courseId, assignId); return; }
+        AssignmentDialog ad(courseId, this, assignId);
+        if (ad.exec() == QDialog::Accepted) timeline_->invalidate();
+    }
+
+    // Only the due-ascending, unfiltered view can page lazily (see AssignmentTableModel).
+    void updateAssignDrain() {
+        const auto* header = assigns_->horizontalHeader();
+        assignModel_->setDrain(!assignFilter_->text().isEmpty() || header->sortIndicatorSection() != AssignmentTableModel::ColDue
+                               || header->sortIndicatorOrder() != Qt::AscendingOrder);
+    }
+
+    int selectedAssignmentId() const {
+        const auto idx = assigns_->currentIndex();
+        return idx.isValid() ? assignModel_->idAt(assignProxy_->mapToSource(idx).row()) : -1;
+    }
+
+    QList<int> selectedAssignmentIds() const {
+        QList<int> ids;
+        for (const auto& idx : assigns_->selectionModel()->selectedRows())
+            ids << assignModel_->idAt(assignProxy_->mapToSource(idx).row());
+        return ids;
     }
 
+    // Full rebuild of the Upcoming window; deltas go through upcomingChanged/refillUpcoming.
     void reloadUpcoming() {
-        upcoming_->clear(); if (semesterId_ < 0) return;
-        std::priority_queue<Assignment, std::vector<Assignment>, DueSooner> pq;
-
-        QSqlQuery q; q.prepare(R"(SELECT a.id, a.course_id, a.type, a.title, a.due_at_utc, a.topics
-                     FROM assignments a
-                     JOIN courses c ON a.course_id = c.id
-                     WHERE c.semester_id = ? AND c.user_id = ?
-                     ORDER BY a.due_at_utc)");
-        q.addBindValue(semesterId_);
-        q.addBindValue(userId_);
-        if (q.exec()) while (q.next()) {
-            Assignment a; a.id = q.value(0).toInt(); a.courseId = q.value(1).toInt();
-            a.type = parseAssignType(q.value(2).toString());
-            a.title = q.value(3).toString();
-            a.dueAtUtc = QDateTime::fromSecsSinceEpoch(q.value(4).toLongLong()).toUTC();
-            if (!q.value(5).isNull()) a.topics = q.value(5).toString();
-            pq.push(a);
-        }
-
-        int shown = 0;
-        while (!pq.empty() && shown < 10) {
-            auto a = pq.top(); pq.pop();
-            QSqlQuery qc; qc.prepare("SELECT code FROM courses WHERE id=?"); qc.addBindValue(a.courseId); qc.exec(); qc.next();
-            const auto code = qc.value(0).toString();
-            const auto dueLocal = QLocale().toString(a.dueAtUtc.toLocalTime(), QLocale::ShortFormat);
-            auto text = QString("[%1] %2 — %3 (%4)").arg(toString(a.type), code, a.title, dueLocal);
-            if (a.topics && !a.topics->isEmpty()) text += "  •  " + *a.topics;
-            upcoming_->addItem(text); shown++;
-        }
-    }
-
-    void loadSemesterIntoControls() {
-        QSqlQuery q; q.prepare("SELECT term, year FROM semesters WHERE id=?"); q.addBindValue(semesterId_);
-        if (q.exec() && q.next()) { term_->setCurrentText(q.value(0).toString()); year_->setValue(q.value(1).toInt()); }
+        const quint64 gen = ++upcomingGen_;
+        upcomingRefillPending_ = false;
+        const bool urgent = urgentFirst();
+        upcomingLabel_->setText(urgent ? "Upcoming (most urgent first)" : "Upcoming (soonest first)");
+        if (semesterId_ < 0) { upcomingIdx_.reset({}, 0); upcoming_->clear(); reminders_.reset(upcomingIdx_.entries()); return; }
+        const int k = upcomingLimit_->value();
+        // Reminders always follow the soonest-due window, whatever order is displayed.
+        using Windows = std::pair<std::vector<Assignment>, std::vector<Assignment>>;  // (shown, soonest due)
+        reads_.post(this, [u = userId_, sem = semesterId_, now = QDateTime::currentSecsSinceEpoch(), k, urgent](SqlRepo& r) {
+            if (!urgent) return Windows{fetchUpcoming(r, u, sem, now, k), {}};
+            return Windows{fetchUrgent(r, u, sem, now, k, WorkloadPriority{}), fetchUpcoming(r, u, sem, now, k)};
+        }, [this, gen, k, urgent](Windows items) {
+            if (gen != upcomingGen_) return;  // a newer refresh is already queued
+            Metrics::Scope scope("ui.upcoming");
+            showUpcoming(std::move(items.first), k, urgent, items.second);
+            StartupTrace::instance().markOnce("upcoming loaded");
+        });
+    }
+
+    // A ranked window is in score order, so reminders come from soonestDue instead.
+    void showUpcoming(std::vector<Assignment> items, int k, bool ranked, const std::vector<Assignment>& soonestDue = {}) {
+        upcomingIdx_.reset(std::move(items), k, ranked);
+        int row = 0;
+        for (const auto& [key, a] : upcomingIdx_.entries()) listRow(upcoming_, row++)->setText(upcomingText(a));
+        trimList(upcoming_, row);
+        if (!ranked) { reminders_.reset(upcomingIdx_.entries()); return; }
+        UpcomingIndex byDue;
+        byDue.reset(soonestDue, k);
+        reminders_.reset(byDue.entries());
+    }
+
+    bool urgentFirst() const { return upcomingOrder_->currentIndex() == 1; }
+
+    void upcomingChanged(const Assignment& a) {
+        // One edit can move every score (course load), so the ranked window is re-scored as a whole.
+        if (urgentFirst()) { refresh_.mark(RefreshScheduler::Upcoming); return; }
+        upcomingIdx_.upsert(a, QDateTime::currentSecsSinceEpoch());
+        refillUpcoming();
+    }
+
+    // Tops the window back up to K after removals, fetching only the missing tail.
+    // A ranked window is reloaded instead: removals shift course loads, and the
+    // reminders' due-ordered window may hold rows the ranked one does not.
+    void refillUpcoming() {
+        if (semesterId_ >= 0 && urgentFirst()) { refresh_.mark(RefreshScheduler::Upcoming); return; }
+        if (!upcomingIdx_.needsRefill() || upcomingRefillPending_ || semesterId_ < 0) return;
+        upcomingRefillPending_ = true;
+        const int need = upcomingIdx_.missing();
+        reads_.post(this, [u = userId_, sem = semesterId_, now = QDateTime::currentSecsSinceEpoch(), need, after = upcomingIdx_.lastKey()](SqlRepo& r) {
+            return fetchUpcoming(r, u, sem, now, need, after);
+        }, [this, gen = upcomingGen_, need](std::vector<Assignment> items) {
+            if (gen != upcomingGen_) return;
+            upcomingRefillPending_ = false;
+            const int added = upcomingIdx_.appendRefill(std::move(items), need);
+            if (upcomingIdx_.needsRefill()) { if (added > 0) refillUpcoming(); else refresh_.mark(RefreshScheduler::Upcoming); }
+        });
+    }
+
+    void updateMemoryReadout() {
+        const qint64 rss = residentBytes();
+        if (rss < 0) { memLabel_->hide(); memTimer_.stop(); return; }
+        peakRss_ = std::max(peakRss_, rss);
+        if (memBudget_ > 0 && rss > memBudget_) trimCaches();
+        memLabel_->setText(QStringLiteral("Memory: ") % uiLocale().formattedDataSize(rss, 1));
+        memLabel_->setToolTip(QStringLiteral("Resident size; peak this session ") % uiLocale().formattedDataSize(peakRss_, 1));
+    }
+
+    // Over the memory budget: drops the signed-out users' partitions and the
+    // active user's cached semesters; what is on screen stays in its models.
+    void trimCaches() {
+        partitions_.clear();
+        courseCache_.clear();
+    }
+
+    // File > Switch User. The outgoing user's caches are parked in
+    // partitions_, so switching back shows their courses and last Upcoming
+    // window at once while the usual refresh runs behind them.
+    void switchUser() {
+        AuthDialog auth(this);
+        if (auth.exec() != QDialog::Accepted || auth.userId() < 0 || auth.userId() == userId_) return;
+        UserPartition out;
+        out.semesterId = semesterId_;
+        out.courses = std::exchange(courseCache_, LruCache<int, std::vector<Course>>{kCachedSemesters});
+        for (const auto& [key, a] : upcomingIdx_.entries()) out.upcoming.push_back(a);
+        partitions_.put(userId_, std::move(out));
+
+        userId_ = auth.userId();
+        ++*coursesGen_; ++*searchGen_; ++upcomingGen_; ++conflictsGen_;  // results in flight belong to the old user
+        upcomingRefillPending_ = false;
+        search_->clear();
+        timeline_->setUser(userId_);
+        std::vector<Assignment> upcoming;
+        if (auto in = partitions_.take(userId_)) {
+            courseCache_ = std::move(in->courses);
+            upcoming = std::move(in->upcoming);
+            if (in->semesterId > 0) semesterId_ = in->semesterId;
+        }
+        statusBar()->showMessage("Signed in as " + auth.username(), 5000);
+        if (semesterId_ < 0) { showUpcoming({}, 0, false); pickSemester(); return; }
+        loadSemesterIntoControls([this, upcoming = std::move(upcoming)]() mutable {
+            // A cached course list fills courseDir_ right here, which the parked Upcoming rows need for their codes.
+            const bool warm = courseCache_.find(semesterId_) != nullptr;
+            loadCourses();
+            showUpcoming(warm ? std::move(upcoming) : std::vector<Assignment>{}, upcomingLimit_->value(), urgentFirst());
+            refresh_.mark(RefreshScheduler::Upcoming | RefreshScheduler::Conflicts | RefreshScheduler::Search);
+        });
+    }
+
+    // Course codes changed: retext the visible rows without touching SQLite.
+    void refreshUpcomingTexts() {
+        int row = 0;
+        for (const auto& [key, a] : upcomingIdx_.entries())
+            if (auto* it = upcoming_->item(row++)) it->setText(upcomingText(a));
+        populateConflicts();
+    }
+
+    void notifyDue(const std::vector<Assignment>& due) {
+        QStringList lines;
+        for (const auto& a : due) {
+            if (lines.size() == 5) { lines << QString("…and %1 more").arg(due.size() - 5); break; }
+            lines << QString("[%1] %2 — %3, due %4").arg(toString(a.type), courseDir_.code(a.courseId), a.title, shortDateTime(a.dueAtUtc));
+        }
+        const QString title = due.size() == 1 ? QString("Deadline coming up") : QString("%1 deadlines coming up").arg(due.size());
+        if (tray_->isVisible()) tray_->showMessage(title, lines.join('\n'), QSystemTrayIcon::Information, 15000);
+        else statusBar()->showMessage(title + ": " + lines.join("; "), 60000);
+    }
+
+    // Conflicts: one full sweep per semester, then per-save patches.
+    void reloadConflicts() {
+        const quint64 gen = ++conflictsGen_;
+        scheduled_.clear();
+        if (semesterId_ < 0) { conflictIdx_.reset({}); populateConflicts(); return; }
+        reads_.post(this, [u = userId_, sem = semesterId_](SqlRepo& r) { return fetchScheduleItems(r, u, sem); },
+                    [this, gen](AssignmentStore items) {
+            if (gen != conflictsGen_) return;
+            conflictIdx_.reset(scheduleEntries(items));
+            scheduled_ = std::move(items);
+            populateConflicts();
+        });
+    }
+
+    // a == nullopt (or an entry that blocks no time) drops it from the index.
+    void scheduleChanged(int id, const std::optional<Assignment>& a) {
+        const auto span = a ? scheduleSpan(*a) : std::nullopt;
+        if (!span && !conflictIdx_.contains(id)) return;
+        conflictIdx_.upsert(id, span);
+        if (span) scheduled_.upsert(*a); else scheduled_.remove(id);
+        populateConflicts();
+    }
+
+    void scheduleRemoved(const QList<int>& ids) {
+        bool changed = false;
+        for (int id : ids) if (conflictIdx_.contains(id)) { conflictIdx_.remove(id); scheduled_.remove(id); changed = true; }
+        if (changed) populateConflicts();
+    }
+
+    void scheduleCoursesRemoved(const QList<int>& courseIds) {
+        QList<int> ids;
+        for (AssignmentStore::Row r = 0; r < scheduled_.size(); ++r)
+            if (courseIds.contains(scheduled_.courseId(r))) ids << scheduled_.id(r);
+        scheduleRemoved(ids);
+    }
+
+    void populateConflicts() {
+        Metrics::Scope scope("ui.conflicts");
+        int row = 0;
+        for (const auto& [x, y] : conflictIdx_.pairs()) {
+            const auto ra = scheduled_.rowOf(x), rb = scheduled_.rowOf(y);
+            if (!ra || !rb) continue;
+            const qint64 overlapFrom = std::max(scheduled_.span(*ra)->begin, scheduled_.span(*rb)->begin);
+            listRow(conflicts_, row++)->setText(shortDateTime(QDateTime::fromSecsSinceEpoch(overlapFrom)) % u"  "
+                                                % courseDir_.code(scheduled_.courseId(*ra)) % u' ' % scheduled_.title(*ra) % u" ⟷ "
+                                                % courseDir_.code(scheduled_.courseId(*rb)) % u' ' % scheduled_.title(*rb));
+        }
+        trimList(conflicts_, row);
+        conflictsLabel_->setText(conflictIdx_.pairs().empty() ? QString("Conflicts") : QString("Conflicts (%1)").arg(conflictIdx_.pairs().size()));
+    }
+
+    QString upcomingText(const Assignment& a) const {
+        QString text = u'[' % toString(a.type) % u"] " % courseDir_.code(a.courseId) % u" — " % a.title % u" (" % shortDateTime(a.dueAtUtc) % u')';
+        if (a.topics && !a.topics->isEmpty()) text += u"  •  " % *a.topics;
+        return text;
+    }
+
+    // then() runs once archived_ is known, since it picks the source of every later read.
+    void loadSemesterIntoControls(std::function<void()> then) {
+        struct Row { QString term; int year{}; bool archived{false}; };
+        const quint64 gen = ++semesterGen_;
+        reads_.post(this, [sem = semesterId_](SqlRepo& r) {
+            Row row;
+            if (auto q = r.exec("SELECT term, year, archived FROM semesters WHERE id=?", {sem}); q && q.next())
+                row = Row{q->value(0).toString(), q->value(1).toInt(), q->value(2).toBool()};
+            return row;
+        }, [this, gen, then = std::move(then)](Row row) {
+            if (gen != semesterGen_) return;  // another semester was picked meanwhile
+            if (!row.term.isEmpty()) { term_->setCurrentText(row.term); year_->setValue(row.year); }
+            archived_ = row.archived;
+            updateArchiveUi();
+            then();
+        });
+    }
+
+    // Archived terms are browse-only: courses and assignments come from the
+    // archive file, and Upcoming, conflicts and search (live data) stay empty.
+    ConnectionPool::Source source() const { return archived_ ? ConnectionPool::Source::Archive : ConnectionPool::Source::Live; }
+
+    void updateArchiveUi() {
+        for (auto* b : editButtons_) b->setEnabled(!archived_);
+        importAct_->setEnabled(!archived_);
+        exportAct_->setEnabled(!archived_);
+        archiveAct_->setEnabled(semesterId_ >= 0 && !archived_);
+        restoreAct_->setEnabled(archived_);
+        coursesLabel_->setText(archived_ ? QString("Courses (archived, read-only)") : QString("Courses"));
+    }
+
+    void archiveCurrentSemester() {
+        if (semesterId_ < 0 || archived_) return;
+        QString text = QString("Move %1 %2 to the archive? It stays browsable, read-only, until restored. "
+                               "Every account's courses for this term move with it.").arg(term_->currentText()).arg(year_->value());
+        reads_.post(this, [sem = semesterId_](SqlRepo& r) { return semesterFinished(r, sem, QDateTime::currentSecsSinceEpoch()); },
+                    [this, sem = semesterId_, text](bool finished) mutable {
+            if (sem != semesterId_) return;
+            if (!finished) text += "\n\nThis term still has deadlines ahead.";
+            if (QMessageBox::question(this, "Archive Semester", text) == QMessageBox::Yes) moveCurrentSemester(true);
+        });
+    }
+
+    // Sync runs on a connection of its own; the UI connection and the DB worker
+    // only wait for the short per-batch write transactions. interactive asks
+    // for a directory when none is configured and reports errors in a dialog.
+    void syncNow(bool interactive) {
+        if (syncRunning_) return;
+        QSettings settings(settingsPath(), QSettings::IniFormat);
+        QString dir = settings.value("sync/dir").toString();
+        if (dir.isEmpty()) {
+            if (!interactive) return;
+            dir = QFileDialog::getExistingDirectory(this, "Sync Folder");
+            if (dir.isEmpty()) return;
+            settings.setValue("sync/dir", dir);
+        }
+        syncRunning_ = true;
+        statusBar()->showMessage("Syncing…");
+        runOnPoolConnection(this, [dir](SqlRepo& repo) { return syncWithDirectory(repo, dir); }, [this, interactive](SyncResult res) {
+            syncRunning_ = false;
+            if (!res.error.isEmpty()) {
+                if (interactive) QMessageBox::warning(this, "Sync failed", res.error);
+                else statusBar()->showMessage("Sync failed: " + res.error, 10000);
+                return;
+            }
+            if (res.received > 0) {
+                courseCache_.clear();
+                partitions_.clear();
+                timeline_->invalidate();
+                refresh_.mark(RefreshScheduler::Courses | RefreshScheduler::Upcoming | RefreshScheduler::Conflicts | RefreshScheduler::Search);
+            }
+            statusBar()->showMessage(QString("Synced: %1 change(s) in, %2 out.").arg(res.received).arg(res.sent), 5000);
+        });
+    }
+
+    // Runs on a connection of its own: the copy and the VACUUM can take a while on a large file.
+    void moveCurrentSemester(bool toArchive) {
+        if (semesterId_ < 0) return;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        runOnPoolConnection(this, [sem = semesterId_, toArchive](SqlRepo& repo) {
+            return toArchive ? archiveSemester(repo, sem) : restoreSemester(repo, sem);
+        }, [this, sem = semesterId_, toArchive](ArchiveResult res) {
+            QApplication::restoreOverrideCursor();
+            if (!res.error.isEmpty()) { QMessageBox::warning(this, toArchive ? "Archive failed" : "Restore failed", res.error); return; }
+            courseCache_.remove(sem);
+            partitions_.clear();  // the move covers every user's courses of the term
+            timeline_->invalidate();
+            if (sem == semesterId_) loadSemesterIntoControls([this] {
+                refresh_.mark(RefreshScheduler::Courses | RefreshScheduler::Upcoming | RefreshScheduler::Conflicts | RefreshScheduler::Search);
+            });
+            QString msg = QString("%1 %2 course(s), %3 assignment(s).").arg(toArchive ? "Archived" : "Restored").arg(res.courses).arg(res.assignments);
+            if (toArchive) msg += QString(" Database: %1 → %2 KiB.").arg(res.bytesBefore / 1024).arg(res.bytesAfter / 1024);
+            statusBar()->showMessage(msg, 8000);
+        });
     }
 
 private:
     int userId_{-1}, semesterId_{-1};
+    bool archived_{false};  // semesterId_ lives in the archive file
+    quint64 semesterGen_{0};
+    bool syncRunning_{false};
+    QTimer syncTimer_;
+    QLabel* memLabel_{};
+    QTimer memTimer_;
+    qint64 peakRss_{0};
+    DbWorker& db_;        // writes, in order
+    ConnectionPool& reads_;
+    bool firstPaintDone_{false};
+    std::shared_ptr<std::atomic<quint64>> coursesGen_ = std::make_shared<std::atomic<quint64>>(0);
+    QLineEdit* search_{};
+    QListWidget* searchResults_{};
+    QTimer searchDebounce_;
+    std::shared_ptr<std::atomic<quint64>> searchGen_ = std::make_shared<std::atomic<quint64>>(0);
+    RefreshScheduler refresh_;
+    quint64 conflictsGen_{0};
+    ConflictIndex conflictIdx_;
+    AssignmentStore scheduled_;  // entries held by conflictIdx_
+    ReminderScheduler reminders_;
+    QSystemTrayIcon* tray_{};
+    QLabel* conflictsLabel_{};
+    QListWidget* conflicts_{};
+    quint64 upcomingGen_{0};
+    bool upcomingRefillPending_{false};
+    UpcomingIndex upcomingIdx_;
+    std::vector<std::unique_ptr<QListWidgetItem>> spareUpcoming_;  // taken out by deltas, reused by inserts
     QComboBox* term_{}; QSpinBox* year_{};
-    QListWidget* courses_{}; QTableWidget* assigns_{}; QListWidget* upcoming_{};
+    QListView* courses_{}; QTableView* assigns_{}; QListWidget* upcoming_{};
+    QLabel* coursesLabel_{};
+    QList<QPushButton*> editButtons_;
+    QAction* importAct_{}; QAction* exportAct_{}; QAction* archiveAct_{}; QAction* restoreAct_{};
+    CourseListModel* courseModel_{};
+    TimelineView* timeline_{};
+    AssignmentTableModel* assignModel_{}; QSortFilterProxyModel* assignProxy_{};
+    QLineEdit* assignFilter_{};
+    QSpinBox* upcomingLimit_{};
+    QComboBox* upcomingOrder_{};
+    QLabel* upcomingLabel_{};
+    QLabel* assignsLabel_{};
+    CourseDirectory courseDir_;
+    static constexpr std::size_t kCachedSemesters = 8;
+    LruCache<int, std::vector<Course>> courseCache_{kCachedSemesters};  // semester id -> fetchCourses rows
+    // Caches of users signed out through Switch User
+    struct UserPartition {
+        int semesterId{-1};
+        LruCache<int, std::vector<Course>> courses{kCachedSemesters};
+        std::vector<Assignment> upcoming;  // last Upcoming window, shown until the refresh lands
+    };
+    static constexpr std::size_t kCachedUsers = 4;
+    LruCache<int, UserPartition> partitions_{kCachedUsers};
+    static constexpr int kDefaultMemoryBudgetMb = 512;
+    qint64 memBudget_{0};  // resident bytes past which trimCaches() runs; 0 = never
+};
+
+// Headless batch mode: `coursepilot_single <command> [options]` runs on a
+// QCoreApplication with the same DB layer and no widget stack or display,
+// for cron jobs (deadline exports, reminder checks, maintenance).
+static const QStringList& cliCommands() {
+    static const QStringList cmds{"upcoming", "import", "export", "vacuum", "kdf-bench", "conflicts", "archive", "sync"};
+    return cmds;
+}
+
+[[maybe_unused]] static bool isCliCommand(const char* arg) { return cliCommands().contains(QString::fromLocal8Bit(arg)); }
+
+static int lookupUserId(SqlRepo& repo, const QString& username) {
+    auto q = repo.exec("SELECT id FROM users WHERE username = ?", {username});
+    return q && q.next() ? q->value(0).toInt() : -1;
+}
+
+static int lookupSemesterId(SqlRepo& repo, const QString& term, int year) {
+    auto q = repo.exec("SELECT id FROM semesters WHERE term=? AND year=?", {term, year});
+    return q && q.next() ? q->value(0).toInt() : -1;
+}
+
+[[maybe_unused]] static int runCli(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout), err(stderr);
+
+    QCommandLineParser cli;
+    cli.setApplicationDescription("CoursePilot headless mode. Commands: " + cliCommands().join(", "));
+    cli.addHelpOption();
+    cli.addPositionalArgument("command", "upcoming | import | export | vacuum | kdf-bench | conflicts | archive | sync");
+    const QCommandLineOption userOpt("user", "Username (required except for export --all and vacuum).", "name");
+    const QCommandLineOption termOpt("term", "Fall or Spring (default: current term).", "term");
+    const QCommandLineOption yearOpt("year", "Semester year (default: current year).", "year");
+    const QCommandLineOption allOpt("all", "export: every semester (and every user without --user); conflicts: every user; archive: every finished term.");
+    const QCommandLineOption limitOpt("limit", "upcoming: number of deadlines (default 10).", "k", QString::number(kDefaultUpcomingLimit));
+    const QCommandLineOption fileOpt({"f", "file"}, "import: CSV/ICS input; export: output path (default stdout).", "path");
+    const QCommandLineOption formatOpt("format", "export: csv, ics or jsonl (default: from --file, else csv).", "fmt");
+    const QCommandLineOption courseOpt("course", "import: course code for rows without one.", "code");
+    const QCommandLineOption targetMsOpt("target-ms", "kdf-bench: login hashing budget (default 250).", "ms", "250");
+    const QCommandLineOption writeOpt("write", "kdf-bench: store the result in coursepilot.ini.");
+    const QCommandLineOption restoreOpt("restore", "archive: move --term/--year back into the live database.");
+    const QCommandLineOption dirOpt("dir", "sync: shared directory (default: [sync] dir in coursepilot.ini).", "path");
+    const QCommandLineOption urgentOpt("urgent", "upcoming: most urgent first (type, effort, course load) instead of soonest.");
+    for (const auto& o : {userOpt, termOpt, yearOpt, allOpt, limitOpt, urgentOpt, fileOpt, formatOpt, courseOpt, targetMsOpt, writeOpt, restoreOpt, dirOpt}) cli.addOption(o);
+    StorageProfile::addOptions(cli);
+    cli.process(app);
+
+    const QString cmd = cli.positionalArguments().value(0);
+    if (cmd == "kdf-bench") {
+        // No DB needed: measure PBKDF2 throughput and suggest a cost for this machine.
+        const int targetMs = std::max(1, cli.value(targetMsOpt).toInt());
+        const int iterations = calibrateKdfIterations(targetMs);
+        QElapsedTimer t;
+        t.start();
+        pbkdf2Sha256("calibration", QByteArray(16, 'x'), iterations);
+        out << "pbkdf2_iterations=" << iterations << "  (" << t.elapsed() << " ms measured, target " << targetMs
+            << " ms, configured " << configuredKdfIterations() << ")\n";
+        if (cli.isSet(writeOpt)) {
+            QSettings s(settingsPath(), QSettings::IniFormat);
+            s.setValue("security/pbkdf2_iterations", iterations);
+            out << "Saved to " << s.fileName() << '\n';
+        }
+        return 0;
+    }
+    auto& storage = StorageProfile::active();
+    storage.load(QSettings(settingsPath(), QSettings::IniFormat));
+    storage.applyOptions(cli);
+
+    SqlRepo repo;
+    if (!repo.open() || !repo.migrate()) { err << "Could not open or migrate SQLite DB.\n"; return 1; }
+    upgradeArchive(repo);
+
+    int userId = -1;
+    if (cli.isSet(userOpt)) {
+        userId = lookupUserId(repo, cli.value(userOpt));
+        if (userId < 0) { err << "Unknown user: " << cli.value(userOpt) << '\n'; return 1; }
+    }
+    const QDate today = QDate::currentDate();
+    const QString term = cli.isSet(termOpt) ? cli.value(termOpt) : QString(today.month() <= 6 ? "Spring" : "Fall");
+    const int year = cli.isSet(yearOpt) ? cli.value(yearOpt).toInt() : today.year();
+    const bool allSemesters = cli.isSet(allOpt);
+    const int semesterId = allSemesters ? -1 : lookupSemesterId(repo, term, year);
+    const auto needUserAndSemester = [&] {
+        if (userId < 0) { err << cmd << " needs --user\n"; return false; }
+        if (semesterId < 0) { err << "No semester " << term << ' ' << year << '\n'; return false; }
+        return true;
+    };
+
+    if (cmd == "upcoming") {
+        if (!needUserAndSemester()) return 1;
+        CourseDirectory dir;
+        dir.reset(semesterId);
+        for (const auto& c : fetchCourses(repo, userId, semesterId)) dir.upsert(c);
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        const int k = cli.value(limitOpt).toInt();
+        for (const auto& a : cli.isSet(urgentOpt) ? fetchUrgent(repo, userId, semesterId, now, k, WorkloadPriority{})
+                                                  : fetchUpcoming(repo, userId, semesterId, now, k)) {
+            out << a.dueAtUtc.toLocalTime().toString("yyyy-MM-dd HH:mm") << "  [" << toString(a.type) << "] "
+                << dir.code(a.courseId) << " — " << a.title;
+            if (a.topics && !a.topics->isEmpty()) out << "  •  " << *a.topics;
+            out << '\n';
+        }
+        return 0;
+    }
+
+    if (cmd == "import") {
+        if (!needUserAndSemester()) return 1;
+        if (!cli.isSet(fileOpt)) { err << "import needs --file\n"; return 2; }
+        ImportOptions opt;
+        opt.userId = userId; opt.semesterId = semesterId;
+        if (cli.isSet(courseOpt)) {
+            for (const auto& c : fetchCourses(repo, userId, semesterId))
+                if (c.code.compare(cli.value(courseOpt), Qt::CaseInsensitive) == 0) opt.defaultCourseId = c.id;
+            if (opt.defaultCourseId < 0) { err << "Unknown course: " << cli.value(courseOpt) << '\n'; return 1; }
+        }
+        QFile f(cli.value(fileOpt));
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) { err << "Cannot open " << f.fileName() << ": " << f.errorString() << '\n'; return 1; }
+        auto reader = makeImportReader(f.fileName(), f);
+        const std::atomic_bool never{false};
+        const auto res = importAssignments(repo, *reader, opt, never, {});
+        if (!res.error.isEmpty()) { err << res.error << '\n'; return 1; }
+        out << "Imported " << res.inserted << " assignment(s), created " << res.coursesCreated
+            << " course(s), skipped " << res.skipped << ".\n";
+        for (const auto& p : res.problems) err << "  " << p << '\n';
+        return 0;
+    }
+
+    if (cmd == "export") {
+        if (!allSemesters && !needUserAndSemester()) return 1;
+        const ExportScope scope{userId, semesterId};
+        const QString path = cli.value(fileOpt);
+        ExportFormat fmt = exportFormatForPath(path);
+        if (cli.isSet(formatOpt)) fmt = exportFormatForPath("x." + cli.value(formatOpt));
+        ExportResult res;
+        if (path.isEmpty() || path == "-") {
+            QFile so;
+            if (!so.open(stdout, QIODevice::WriteOnly)) { err << "Cannot write to stdout\n"; return 1; }
+            res = exportAssignments(repo, so, fmt, scope);
+        } else {
+            res = exportToFile(repo, path, fmt, scope);
+        }
+        if (!res.error.isEmpty()) { err << res.error << '\n'; return 1; }
+        err << "Exported " << res.rows << " assignment(s).\n";
+        return 0;
+    }
+
+    if (cmd == "conflicts") {
+        // One sweep per user over the semester; --all walks the whole cohort.
+        const int sem = lookupSemesterId(repo, term, year);
+        if (sem < 0) { err << "No semester " << term << ' ' << year << '\n'; return 1; }
+        std::vector<std::pair<int, QString>> users;
+        if (userId >= 0) users.push_back({userId, cli.value(userOpt)});
+        else if (!cli.isSet(allOpt)) { err << "conflicts needs --user or --all\n"; return 1; }
+        else if (auto q = repo.exec("SELECT DISTINCT u.id, u.username FROM users u JOIN courses c ON c.user_id = u.id WHERE c.semester_id = ? ORDER BY u.username", {sem}))
+            while (q.next()) users.push_back({q->value(0).toInt(), q->value(1).toString()});
+        int total = 0;
+        for (const auto& [uid, name] : users) {
+            CourseDirectory dir;
+            dir.reset(sem);
+            for (const auto& c : fetchCourses(repo, uid, sem)) dir.upsert(c);
+            const auto items = fetchScheduleItems(repo, uid, sem);
+            const auto describe = [&](int id) {
+                const auto r = *items.rowOf(id);
+                return QDateTime::fromSecsSinceEpoch(items.span(r)->begin).toLocalTime().toString("yyyy-MM-dd HH:mm")
+                     + "  [" + toString(items.type(r)) + "] " + dir.code(items.courseId(r)) + " — " + items.title(r).toString();
+            };
+            for (const auto& [x, y] : ConflictIndex::sweep(scheduleEntries(items))) {
+                out << name << "  " << describe(x) << "  <->  " << describe(y) << '\n';
+                ++total;
+            }
+        }
+        err << total << " conflict(s) across " << users.size() << " user(s).\n";
+        return 0;
+    }
+
+    if (cmd == "vacuum") {
+        const qint64 before = QFileInfo(repo.db().databaseName()).size();
+        // One statement at a time: VACUUM refuses to run while another is in progress.
+        bool ok = bool(repo.exec("PRAGMA optimize"));
+        ok = ok && bool(repo.exec("VACUUM"));
+        if (ok && storage.usesWal()) ok = bool(repo.exec("PRAGMA wal_checkpoint(TRUNCATE)"));
+        if (!ok) { err << "VACUUM failed: " << repo.db().lastError().text() << '\n'; return 1; }
+        out << "Vacuumed " << repo.db().databaseName() << ": " << before << " -> "
+            << QFileInfo(repo.db().databaseName()).size() << " bytes\n";
+        return 0;
+    }
+
+    if (cmd == "archive") {
+        // --all takes every finished term still in the live file; a named term moves whether finished or not.
+        const bool restore = cli.isSet(restoreOpt);
+        std::vector<std::pair<int, QString>> terms;
+        if (allSemesters && !restore) {
+            const qint64 now = QDateTime::currentSecsSinceEpoch();
+            if (auto q = repo.exec("SELECT id, term || ' ' || year FROM semesters WHERE archived = 0 AND id IN (SELECT semester_id FROM courses) ORDER BY year, term DESC"))
+                while (q.next()) terms.push_back({q->value(0).toInt(), q->value(1).toString()});
+            std::erase_if(terms, [&](const auto& t) { return !semesterFinished(repo, t.first, now); });
+        } else {
+            if (allSemesters || !cli.isSet(termOpt) || !cli.isSet(yearOpt)) { err << "archive needs --term and --year (or --all, without --restore)\n"; return 1; }
+            if (semesterId < 0) { err << "No semester " << term << ' ' << year << '\n'; return 1; }
+            if (semesterArchived(repo, semesterId) != restore) { err << term << ' ' << year << (restore ? " is not archived\n" : " is already archived\n"); return 1; }
+            terms.push_back({semesterId, term + ' ' + QString::number(year)});
+        }
+        for (std::size_t i = 0; i < terms.size(); ++i) {
+            const auto res = restore ? restoreSemester(repo, terms[i].first) : archiveSemester(repo, terms[i].first, i + 1 == terms.size());
+            if (!res.error.isEmpty()) { err << terms[i].second << ": " << res.error << '\n'; return 1; }
+            out << (restore ? "Restored " : "Archived ") << terms[i].second << ": " << res.courses << " course(s), " << res.assignments << " assignment(s)\n";
+            if (!restore && i + 1 == terms.size()) out << "Vacuumed " << databasePath() << ": " << res.bytesBefore << " -> " << res.bytesAfter << " bytes\n";
+        }
+        if (terms.empty()) err << "No finished semesters to archive.\n";
+        return 0;
+    }
+
+    if (cmd == "sync") {
+        const QString dir = cli.isSet(dirOpt) ? cli.value(dirOpt) : QSettings(settingsPath(), QSettings::IniFormat).value("sync/dir").toString();
+        if (dir.isEmpty()) { err << "sync needs --dir or [sync] dir in coursepilot.ini\n"; return 1; }
+        const auto res = syncWithDirectory(repo, dir);
+        if (!res.error.isEmpty()) { err << res.error << '\n'; return 1; }
+        out << "Received " << res.received << " change(s) (" << res.skipped << " skipped), sent " << res.sent << "; "
+            << res.batches << " batch(es) via " << dir << '\n';
+        return 0;
+    }
+
+    err << (cmd.isEmpty() ? QString("Missing command") : "Unknown command: " + cmd) << "\n\n" << cli.helpText();
+    return 2;
+}
+
+#ifdef CP_BENCH_MAIN
+// Benchmark build (coursepilot_bench, -DCP_BUILD_BENCH=ON): the same
+// translation unit with this main instead of the GUI one. It generates a
+// synthetic M users x S semesters x C courses x A assignments database in a
+// scratch file, times the repository calls behind the dashboard and the save
+// paths, and prints one JSON document for release-to-release comparison.
+//
+// Allocation figures count global operator new. Qt containers allocate with
+// malloc and are not seen there; on glibc the net heap growth per iteration
+// (mallinfo2) is reported as well.
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define CP_BENCH_HEAP_STATS 1
+#endif
+
+namespace bench {
+std::atomic<quint64> newCalls{0}, newBytes{0};
+}
+
+void* operator new(std::size_t n) {
+    bench::newCalls.fetch_add(1, std::memory_order_relaxed);
+    bench::newBytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    bench::newCalls.fetch_add(1, std::memory_order_relaxed);
+    bench::newBytes.fetch_add(n, std::memory_order_relaxed);
+    return std::malloc(n ? n : 1);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace bench {
+
+struct Dataset { int users = 10, semesters = 8, courses = 6, assignments = 40; quint32 seed = 42; };
+
+static qint64 heapInUse() {
+#ifdef CP_BENCH_HEAP_STATS
+    return qint64(mallinfo2().uordblks);
+#else
+    return 0;
+#endif
+}
+
+// Fills an empty, migrated database in one transaction.
+static bool generate(SqlRepo& repo, const Dataset& d) {
+    static const char* vocab[] = {"graphs", "recursion", "proofs", "integrals", "essays", "lab", "reading",
+                                  "sorting", "hashing", "linear algebra", "probability", "thermodynamics"};
+    QRandomGenerator rng(d.seed);
+    const auto pick = [&](int n) { return int(rng.bounded(n)); };
+    return writeTransaction(repo, [&] {
+        for (int s = 0; s < d.semesters; ++s)
+            if (!repo.exec("INSERT INTO semesters(term, year) VALUES(?,?)", {s % 2 ? "Spring" : "Fall", 2020 + s / 2})) return false;
+        for (int u = 1; u <= d.users; ++u) {
+            if (!repo.exec("INSERT INTO users(username, password_hash, created_at) VALUES(?,?,0)",
+                           {QString("bench%1").arg(u), QByteArray(32, '\0')})) return false;
+            for (int s = 1; s <= d.semesters; ++s) {
+                const qint64 semStart = QDateTime(QDate(2020 + (s - 1) / 2, (s - 1) % 2 ? 1 : 8, 25), QTime(9, 0), QTimeZone::utc()).toSecsSinceEpoch();
+                for (int c = 0; c < d.courses; ++c) {
+                    auto ins = repo.exec("INSERT INTO courses(user_id, semester_id, code, name, color_hex) VALUES(?,?,?,?,?)",
+                                         {u, s, QString("C%1%2").arg(100 + c).arg(QChar('A' + pick(26))), QString("Course %1").arg(c), "#4F46E5"});
+                    if (!ins) return false;
+                    const int courseId = ins->lastInsertId().toInt();
+                    for (int a = 0; a < d.assignments; ++a) {
+                        const auto type = AssignType(pick(7));
+                        const qint64 due = semStart + qint64(pick(16 * 7 * 24)) * 3600;
+                        const bool timed = isExam(type) && pick(2) == 0;
+                        if (!repo.exec(R"(INSERT INTO assignments(course_id, type, title, due_at_utc, topics, notes, start_at_utc, duration_min)
+                                          VALUES(?,?,?,?,?,?,?,?))",
+                                       {courseId, toString(type), QString("%1 %2").arg(toString(type)).arg(a + 1), due,
+                                        QString("%1, %2").arg(vocab[pick(12)], vocab[pick(12)]),
+                                        pick(4) == 0 ? QVariant(QString("Remember to review %1 before class.").arg(vocab[pick(12)])) : QVariant(QString()),
+                                        timed ? QVariant(due) : QVariant(), timed ? QVariant(90 + 30 * pick(3)) : QVariant()}))
+                            return false;
+                    }
+                }
+            }
+        }
+        return true;
+    });
+}
+
+struct Result {
+    QString name;
+    std::vector<qint64> ns;
+    quint64 allocs = 0, allocBytes = 0;
+    qint64 heapDelta = 0;
 };
 
+// Runs f() `iterations` times after `warmup` untimed calls, timing each call.
+template <class F>
+static Result measure(const QString& name, int iterations, F f, int warmup = 3) {
+    for (int i = 0; i < warmup; ++i) f(i);
+    Result r{name, {}, 0, 0, 0};
+    r.ns.reserve(std::size_t(iterations));
+    const quint64 calls0 = newCalls.load(), bytes0 = newBytes.load();
+    const qint64 heap0 = heapInUse();
+    for (int i = 0; i < iterations; ++i) {
+        QElapsedTimer t;
+        t.start();
+        f(i);
+        r.ns.push_back(t.nsecsElapsed());
+    }
+    r.allocs = newCalls.load() - calls0;
+    r.allocBytes = newBytes.load() - bytes0;
+    r.heapDelta = heapInUse() - heap0;
+    return r;
+}
+
+static QJsonObject toJson(Result r) {
+    std::sort(r.ns.begin(), r.ns.end());
+    const auto n = qsizetype(r.ns.size());
+    const auto at = [&](double q) { return n ? double(r.ns[std::size_t(std::min<qsizetype>(n - 1, qsizetype(q * double(n))))]) : 0.0; };
+    double sum = 0;
+    for (qint64 v : r.ns) sum += double(v);
+    QJsonObject ns{{"min", n ? double(r.ns.front()) : 0.0}, {"median", at(0.5)}, {"p95", at(0.95)}, {"mean", n ? sum / double(n) : 0.0}};
+    QJsonObject o{{"name", r.name}, {"iterations", int(n)}, {"ns", ns},
+                  {"new_calls_per_iter", n ? double(r.allocs) / double(n) : 0.0},
+                  {"new_bytes_per_iter", n ? double(r.allocBytes) / double(n) : 0.0}};
+#ifdef CP_BENCH_HEAP_STATS
+    o.insert("heap_delta_bytes", double(r.heapDelta));
+#endif
+    return o;
+}
+
+} // namespace bench
+
+static int runBench(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+    QCommandLineParser cli;
+    cli.setApplicationDescription("CoursePilot benchmarks: synthetic dataset, JSON results on stdout.");
+    cli.addHelpOption();
+    const QCommandLineOption usersOpt("users", "Users (M).", "n", "10");
+    const QCommandLineOption semestersOpt("semesters", "Semesters per user (S).", "n", "8");
+    const QCommandLineOption coursesOpt("courses", "Courses per user and semester (C).", "n", "6");
+    const QCommandLineOption assignmentsOpt("assignments", "Assignments per course (A).", "n", "40");
+    const QCommandLineOption iterOpt("iterations", "Timed iterations per benchmark.", "n", "200");
+    const QCommandLineOption seedOpt("seed", "Generator seed.", "n", "42");
+    const QCommandLineOption dbOpt("db", "Scratch database path (default: a temp file, removed afterwards).", "path");
+    const QCommandLineOption outOpt({"o", "out"}, "Write JSON here instead of stdout.", "path");
+    for (const auto& o : {usersOpt, semestersOpt, coursesOpt, assignmentsOpt, iterOpt, seedOpt, dbOpt, outOpt}) cli.addOption(o);
+    StorageProfile::addOptions(cli);
+    cli.process(app);
+    StorageProfile::active().applyOptions(cli);
+
+    bench::Dataset d;
+    d.users = std::max(1, cli.value(usersOpt).toInt());
+    d.semesters = std::max(1, cli.value(semestersOpt).toInt());
+    d.courses = std::max(1, cli.value(coursesOpt).toInt());
+    d.assignments = std::max(1, cli.value(assignmentsOpt).toInt());
+    d.seed = cli.value(seedOpt).toUInt();
+    const int iterations = std::max(1, cli.value(iterOpt).toInt());
+
+    QTemporaryDir scratch;
+    const QString path = cli.isSet(dbOpt) ? cli.value(dbOpt) : scratch.filePath("bench.db");
+    for (const char* suffix : {"", "-wal", "-shm"}) QFile::remove(path + suffix);
+    databasePathOverride() = path;
+
+    std::vector<bench::Result> results;
+    SqlRepo repo;
+    if (!repo.open()) { err << "Cannot open " << path << '\n'; return 1; }
+    // A schema only migrates once, so the fresh run is a single sample without warm-up.
+    bool migrated = false;
+    results.push_back(bench::measure("runMigrations.fresh", 1, [&](int) { migrated = repo.migrate(); }, 0));
+    if (!migrated) { err << "Migration failed\n"; return 1; }
+    results.push_back(bench::measure("runMigrations.current", iterations, [&](int) { repo.migrate(); }));
+
+    QElapsedTimer gen; gen.start();
+    if (!bench::generate(repo, d)) { err << "Data generation failed: " << repo.lastError().text() << '\n'; return 1; }
+    repo.exec("PRAGMA optimize");
+    const qint64 generateMs = gen.elapsed();
+
+    // Every timed call targets a pseudo-random user/semester/course so caches are not flattered.
+    QRandomGenerator rng(d.seed + 1);
+    const int courseCount = d.users * d.semesters * d.courses;
+    const auto userAt = [&](int i) { return 1 + (i * 7919) % d.users; };
+    const auto semAt = [&](int i) { return 1 + (i * 104729) % d.semesters; };
+    const auto courseAt = [&](int i) { return 1 + (i * 15485863) % courseCount; };
+    const qint64 midSemester = QDateTime(QDate(2020, 10, 15), QTime(12, 0), QTimeZone::utc()).toSecsSinceEpoch();
+
+    results.push_back(bench::measure("loadCourses", iterations, [&](int i) { fetchCourses(repo, userAt(i), semAt(i)); }));
+    results.push_back(bench::measure("loadAssignments.firstPage", iterations, [&](int i) {
+        fetchAssignmentPage(repo, courseAt(i), std::numeric_limits<qint64>::min(), std::numeric_limits<int>::min(), AssignmentTableModel::kFetchBatch);
+    }));
+    for (int k : {kDefaultUpcomingLimit, 100})
+        results.push_back(bench::measure(QString("reloadUpcoming.k%1").arg(k), iterations, [&](int i) { fetchUpcoming(repo, userAt(i), 1, midSemester, k); }));
+    results.push_back(bench::measure("reloadUpcoming.urgent", iterations, [&](int i) {
+        fetchUrgent(repo, userAt(i), 1, midSemester, kDefaultUpcomingLimit, WorkloadPriority{});
+    }));
+    results.push_back(bench::measure("searchAssignments", iterations, [&](int i) { searchAssignments(repo, userAt(i), semAt(i), i % 2 ? "graph" : "recursion proofs"); }));
+    results.push_back(bench::measure("conflicts.sweep", iterations, [&](int i) {
+        ConflictIndex::sweep(scheduleEntries(fetchScheduleItems(repo, userAt(i), semAt(i))));
+    }));
+    results.push_back(bench::measure("CourseDialog.onSave.update", iterations, [&](int i) {
+        saveCourseRow(repo, Course{courseAt(i), 0, 0, QString("U%1").arg(i), QString("Renamed %1").arg(i), "#10B981"});
+    }));
+    results.push_back(bench::measure("AssignmentDialog.onSave.insert", iterations, [&](int i) {
+        Assignment a; a.id = -1; a.courseId = courseAt(i); a.type = AssignType::HW; a.title = QString("Bench insert %1").arg(i);
+        a.dueAtUtc = QDateTime::fromSecsSinceEpoch(midSemester + i * 60).toUTC(); a.topics = QString("graphs");
+        saveAssignmentRow(repo, a);
+    }));
+    results.push_back(bench::measure("AssignmentDialog.onSave.update", iterations, [&](int i) {
+        Assignment a; a.id = 1 + int(rng.bounded(courseCount * d.assignments)); a.courseId = 0; a.type = AssignType::Quiz;
+        a.title = QString("Bench update %1").arg(i); a.dueAtUtc = QDateTime::fromSecsSinceEpoch(midSemester + i * 60).toUTC();
+        saveAssignmentRow(repo, a);
+    }));
+
+    QJsonArray out;
+    for (auto& r : results) out.append(bench::toJson(std::move(r)));
+    QString sqliteVersion;
+    if (auto q = repo.exec("SELECT sqlite_version()"); q && q.next()) sqliteVersion = q->value(0).toString();
+    const QJsonObject doc{
+        {"schema", 1},
+        {"qt", QString::fromLatin1(qVersion())},
+        {"sqlite", sqliteVersion},
+        {"journal_mode", StorageProfile::active().journalMode},
+        {"synchronous", StorageProfile::active().synchronous},
+        {"dataset", QJsonObject{{"users", d.users}, {"semesters", d.semesters}, {"courses", d.courses},
+                                {"assignments", d.assignments}, {"seed", double(d.seed)},
+                                {"assignment_rows", double(courseCount) * d.assignments}, {"generate_ms", double(generateMs)}}},
+        {"rss_bytes", double(residentBytes())},
+        {"results", out},
+    };
+    repo.close();
+
+    const QByteArray json = QJsonDocument(doc).toJson(QJsonDocument::Indented);
+    if (cli.isSet(outOpt)) {
+        QSaveFile f(cli.value(outOpt));
+        if (!f.open(QIODevice::WriteOnly) || f.write(json) != json.size() || !f.commit()) { err << "Cannot write " << f.fileName() << '\n'; return 1; }
+    } else {
+        QFile so;
+        if (!so.open(stdout, QIODevice::WriteOnly)) return 1;
+        so.write(json);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) { return runBench(argc, argv); }
+
+#else
 // Main entry point and MOC glue
 int main(int argc, char** argv) {
+    auto& trace = StartupTrace::instance();
+    trace.mark("main");
+    if (argc > 1 && isCliCommand(argv[1])) return runCli(argc, argv);
+
     QApplication app(argc, argv);
+    trace.mark("QApplication");
 
-    QSqlDatabase db;
-    if (!ensureDbOpen(db) || !runMigrations(db)) {
+    QCommandLineParser cli;
+    cli.addHelpOption();
+    StorageProfile::addOptions(cli);
+    cli.parse(QCoreApplication::arguments());  // tolerate platform/style flags Qt already consumed
+    if (cli.isSet("help")) cli.showHelp();
+    auto& storage = StorageProfile::active();
+    storage.load(QSettings(settingsPath(), QSettings::IniFormat));
+    storage.applyOptions(cli);
+    Metrics::setEnabled(qEnvironmentVariableIntValue("COURSEPILOT_METRICS") != 0
+                        || QSettings(settingsPath(), QSettings::IniFormat).value("diagnostics/metrics", false).toBool());
+    trace.mark("settings loaded");
+
+    SqlRepo repo;
+    if (!repo.open()) {
+        QMessageBox::critical(nullptr, "DB Error", "Could not open or migrate SQLite DB.");
+        return 1;
+    }
+    trace.mark("db opened");
+    if (!repo.migrate()) {
         QMessageBox::critical(nullptr, "DB Error", "Could not open or migrate SQLite DB.");
         return 1;
     }
+    if (!upgradeArchive(repo)) qWarning() << "Could not upgrade the archive file:" << repo.lastError().text();
+    trace.mark("schema checked");
+    SqlRepo::setUi(&repo);
+    DbWorker worker;  // opens its own connection in parallel with the sign-in dialog
+    DbWorker::setShared(&worker);
+    worker.startMaintenance(storage);
+    ConnectionPool reads;
+    ConnectionPool::setShared(&reads);
 
     AuthDialog auth;
+    trace.mark("sign-in shown");
     if (auth.exec() != QDialog::Accepted || auth.userId() < 0) return 0;
+    trace.mark("signed in");
 
     MainWindow w(auth.userId());
     w.show();
     return app.exec();
 }
+#endif
 
 #include "college-course-organizer.moc"
 